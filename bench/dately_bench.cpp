@@ -0,0 +1,458 @@
+/*
+ * rotating_dately_file_sink 与 spdlog 自带 rotating_file_sink / daily_file_sink 的性能对比
+ *
+ * 用法: dately_bench [--dir <日志目录>] [--json <结果文件>] [--quick]
+ *   --dir   测试用的日志目录（会被清空），分别指向tmpfs（如/dev/shm/dately_bench）和真实磁盘
+ *   --json  结果以JSON写入该文件，便于在版本之间比较；默认输出到标准输出
+ *   --quick 缩小规模，用于快速检查
+ *
+ * 场景：
+ *   throughput  1~64线程吞吐量
+ *   latency     每次写日志（sink_it_）的延迟分位数
+ *   rotation    小max_size下的轮转风暴
+ *   retention   预置1k/10k/100k个备份时的启动（扫描目录/读入备份清单）和清理耗时
+ */
+
+#include "spdlog/logger.h"
+#include "spdlog/details/maintenance_worker.h"
+#ifdef SPDLOG_DATELY_ZLIB
+    #include "spdlog/details/backup_compressor.h"
+    #include "spdlog/details/compressed_stream_encoder.h"
+#endif
+#include "spdlog/sinks/combining_dately_file_sink.h"
+#include "spdlog/sinks/daily_file_sink.h"
+#include "spdlog/sinks/preformat_dately_file_sink.h"
+#include "spdlog/sinks/rotating_dately_file_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/sinks/routing_dately_file_sink.h"
+#include "spdlog/sinks/sharded_dately_file_sink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+struct options {
+    std::string dir = "dately_bench_logs";
+    std::string json_file;
+    bool quick = false;
+};
+
+/* 一条测试结果，输出为一个JSON对象 */
+struct result {
+    std::string scenario;
+    std::string sink;
+    std::vector<std::pair<std::string, std::string>> fields;
+
+    void add(const std::string &key, double value) {
+        std::ostringstream ss;
+        ss.precision(12);
+        ss << value;
+        fields.emplace_back(key, ss.str());
+    }
+};
+
+std::vector<result> results;
+
+void clear_directory(const std::string &dir) {
+    mkdir(dir.c_str(), 0777);
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+            unlink((dir + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(d);
+}
+
+/* 目录中文件的总字节数 */
+double directory_bytes(const std::string &dir) {
+    double total = 0;
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        return total;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        struct stat st;
+        if (stat((dir + "/" + entry->d_name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            total += static_cast<double>(st.st_size);
+        }
+    }
+    closedir(d);
+    return total;
+}
+
+double seconds_since(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/* 创建被测sink，每次都在清空的目录中 */
+std::shared_ptr<spdlog::sinks::sink> make_sink(const std::string &kind,
+                                               const std::string &dir,
+                                               std::size_t max_size,
+                                               std::size_t max_files) {
+    using namespace spdlog::sinks;
+    clear_directory(dir);
+    std::chrono::hours max_age(24 * 365);
+
+    if (kind == "dately") {
+        return std::make_shared<rotating_dately_file_sink_mt>(dir + "/app.log", max_age, max_size,
+                                                              max_files);
+    }
+    if (kind == "dately_async") {
+        auto sink = std::make_shared<rotating_dately_file_sink_mt>(dir + "/app.log", max_age,
+                                                                   max_size, max_files);
+        sink->set_maintenance_worker(std::make_shared<spdlog::details::maintenance_worker>());
+        sink->set_standby_file(true);
+        return sink;
+    }
+    if (kind == "dately_aio") {
+        auto sink = std::make_shared<rotating_dately_file_sink_mt>(dir + "/app.log", max_age,
+                                                                   max_size, max_files);
+        sink->set_maintenance_worker(std::make_shared<spdlog::details::maintenance_worker>());
+        sink->set_standby_file(true);
+        sink->set_async_writer(256 * 1024);
+        return sink;
+    }
+#ifdef SPDLOG_DATELY_ZLIB
+    if (kind == "dately_gzip" || kind == "dately_zstd") {
+        /* 备份在后台压缩 */
+        using spdlog::details::backup_compressor;
+        auto sink = std::make_shared<rotating_dately_file_sink_mt>(dir + "/app.log", max_age,
+                                                                   max_size, max_files);
+        sink->set_maintenance_worker(std::make_shared<spdlog::details::maintenance_worker>());
+        sink->set_backup_processor(std::make_shared<backup_compressor>(
+            kind == "dately_gzip" ? backup_compressor::codec::gzip
+                                  : backup_compressor::codec::zstd));
+        return sink;
+    }
+    if (kind == "dately_stream_gzip" || kind == "dately_stream_zstd") {
+        /* 写入时流式压缩 */
+        using spdlog::details::compressed_stream_encoder;
+        auto sink = std::make_shared<rotating_dately_file_sink_mt>(dir + "/app.log", max_age,
+                                                                   max_size, max_files);
+        sink->set_stream_encoder(spdlog::details::make_unique<compressed_stream_encoder>(
+            kind == "dately_stream_gzip" ? compressed_stream_encoder::codec::gzip
+                                         : compressed_stream_encoder::codec::zstd));
+        return sink;
+    }
+#endif
+    if (kind == "dately_binary") {
+        auto sink = std::make_shared<rotating_dately_file_sink_mt>(dir + "/app.log", max_age,
+                                                                   max_size, max_files);
+        sink->set_binary_format(true);
+        return sink;
+    }
+    if (kind == "dately_preformat") {
+        return std::make_shared<preformat_dately_file_sink>(dir + "/app.log", max_age, max_size,
+                                                            max_files);
+    }
+    if (kind == "dately_combining") {
+        return std::make_shared<combining_dately_file_sink>(dir + "/app.log", max_age, max_size,
+                                                            max_files);
+    }
+    if (kind == "dately_sharded") {
+        return std::make_shared<sharded_dately_file_sink>(dir + "/app.log", 0, max_age, max_size,
+                                                          max_files);
+    }
+    if (kind == "dately_routing") {
+        /* 每条记录格式化一次，写入两个输出 */
+        auto sink = std::make_shared<routing_dately_file_sink>(max_age, max_files);
+        sink->add_route(dir + "/app.log", spdlog::level::trace, "", max_size);
+        sink->add_route(dir + "/bench.log", spdlog::level::trace, "bench", max_size);
+        return sink;
+    }
+    if (kind == "rotating") {
+        return std::make_shared<rotating_file_sink_mt>(dir + "/rotating.log", max_size,
+                                                       max_files);
+    }
+    if (kind == "daily") {
+        return std::make_shared<daily_file_sink_mt>(dir + "/daily.log", 0, 0);
+    }
+    throw std::runtime_error("unknown sink kind: " + kind);
+}
+
+const char *const payload = "benchmark payload with enough text to look like a real log line";
+
+void bench_throughput(const options &opts) {
+    std::vector<const char *> kinds = {"dately",           "dately_binary",  "dately_preformat",
+                                       "dately_combining", "dately_sharded", "dately_routing",
+                                       "rotating",         "daily"};
+#ifdef SPDLOG_DATELY_ZLIB
+    kinds.push_back("dately_stream_gzip");
+#endif
+#ifdef SPDLOG_DATELY_ZSTD
+    kinds.push_back("dately_stream_zstd");
+#endif
+    std::vector<int> thread_counts = opts.quick ? std::vector<int>{1, 4}
+                                                : std::vector<int>{1, 2, 4, 8, 16, 32, 64};
+    const std::size_t total = opts.quick ? 20000 : 400000;
+
+    for (const char *kind : kinds) {
+        for (int threads : thread_counts) {
+            auto sink = make_sink(kind, opts.dir, 64 * 1024 * 1024, 10);
+            spdlog::logger logger("bench", sink);
+            std::size_t per_thread = total / static_cast<std::size_t>(threads);
+
+            auto start = bench_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&logger, per_thread] {
+                    for (std::size_t i = 0; i < per_thread; ++i) {
+                        logger.info("{} #{}", payload, i);
+                    }
+                });
+            }
+            for (auto &w : workers) {
+                w.join();
+            }
+            logger.flush();
+            double elapsed = seconds_since(start);
+            double messages = static_cast<double>(per_thread * threads);
+            double bytes_per_msg = directory_bytes(opts.dir) / messages;
+
+            result r{"throughput", kind, {}};
+            r.add("threads", threads);
+            r.add("messages", messages);
+            r.add("seconds", elapsed);
+            r.add("msgs_per_sec", messages / elapsed);
+            r.add("bytes_per_msg", bytes_per_msg);
+            results.push_back(r);
+            std::fprintf(stderr, "throughput %-18s threads=%-3d %12.0f msgs/sec %8.1f bytes/msg\n",
+                         kind, threads, messages / elapsed, bytes_per_msg);
+        }
+    }
+}
+
+void bench_latency(const options &opts) {
+    const char *kinds[] = {"dately",           "dately_async", "dately_aio", "dately_preformat",
+                           "dately_combining", "rotating",     "daily"};
+    std::vector<int> thread_counts = opts.quick ? std::vector<int>{1} : std::vector<int>{1, 8};
+    const std::size_t per_thread = opts.quick ? 10000 : 100000;
+
+    for (const char *kind : kinds) {
+        for (int threads : thread_counts) {
+            /* 4MB的max_size使测量中包含轮转 */
+            auto sink = make_sink(kind, opts.dir, 4 * 1024 * 1024, 10);
+            spdlog::logger logger("bench", sink);
+
+            std::vector<std::vector<std::int64_t>> samples(static_cast<std::size_t>(threads));
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&logger, &samples, t, per_thread] {
+                    auto &mine = samples[static_cast<std::size_t>(t)];
+                    mine.reserve(per_thread);
+                    for (std::size_t i = 0; i < per_thread; ++i) {
+                        auto start = bench_clock::now();
+                        logger.info("{} #{}", payload, i);
+                        mine.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                           bench_clock::now() - start)
+                                           .count());
+                    }
+                });
+            }
+            for (auto &w : workers) {
+                w.join();
+            }
+            logger.flush();
+
+            std::vector<std::int64_t> all;
+            for (auto &s : samples) {
+                all.insert(all.end(), s.begin(), s.end());
+            }
+            std::sort(all.begin(), all.end());
+            auto percentile = [&all](double p) {
+                auto index = static_cast<std::size_t>(p * static_cast<double>(all.size() - 1));
+                return static_cast<double>(all[index]);
+            };
+
+            result r{"latency", kind, {}};
+            r.add("threads", threads);
+            r.add("p50_ns", percentile(0.50));
+            r.add("p90_ns", percentile(0.90));
+            r.add("p99_ns", percentile(0.99));
+            r.add("p999_ns", percentile(0.999));
+            r.add("max_ns", static_cast<double>(all.back()));
+            results.push_back(r);
+            std::fprintf(stderr,
+                         "latency    %-18s threads=%-3d p50=%.0fns p99=%.0fns p99.9=%.0fns "
+                         "max=%.0fns\n",
+                         kind, threads, percentile(0.50), percentile(0.99), percentile(0.999),
+                         static_cast<double>(all.back()));
+        }
+    }
+}
+
+void bench_rotation_storm(const options &opts) {
+    std::vector<const char *> kinds = {"dately", "dately_async", "rotating"};
+#ifdef SPDLOG_DATELY_ZLIB
+    kinds.push_back("dately_gzip");
+#endif
+#ifdef SPDLOG_DATELY_ZSTD
+    kinds.push_back("dately_zstd");
+#endif
+    const std::size_t messages = opts.quick ? 20000 : 200000;
+    const std::size_t max_size = 4096;
+
+    for (const char *kind : kinds) {
+        auto sink = make_sink(kind, opts.dir, max_size, 10);
+        spdlog::logger logger("bench", sink);
+
+        auto start = bench_clock::now();
+        for (std::size_t i = 0; i < messages; ++i) {
+            logger.info("{} #{}", payload, i);
+        }
+        logger.flush();
+        double elapsed = seconds_since(start);
+
+        result r{"rotation", kind, {}};
+        r.add("max_size", static_cast<double>(max_size));
+        r.add("messages", static_cast<double>(messages));
+        r.add("seconds", elapsed);
+        r.add("msgs_per_sec", static_cast<double>(messages) / elapsed);
+        results.push_back(r);
+        std::fprintf(stderr, "rotation   %-18s max_size=%zu %12.0f msgs/sec\n", kind, max_size,
+                     static_cast<double>(messages) / elapsed);
+    }
+}
+
+/* 预置count个备份文件，时间从当前往前每分钟一个 */
+void populate_backups(const std::string &dir, std::size_t count) {
+    clear_directory(dir);
+    std::time_t now = std::time(nullptr);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::time_t t = now - static_cast<std::time_t>(i + 1) * 60;
+        std::tm tm_info = spdlog::details::os::localtime(t);
+        char name[64];
+        std::strftime(name, sizeof(name), "app_%Y%m%d_%H%M%S.log", &tm_info);
+        std::ofstream(dir + "/" + name) << "backup\n";
+    }
+}
+
+void bench_retention(const options &opts) {
+    std::vector<std::size_t> counts = opts.quick ? std::vector<std::size_t>{1000, 10000}
+                                                 : std::vector<std::size_t>{1000, 10000, 100000};
+    std::chrono::hours max_age(24 * 365 * 10);
+
+    for (std::size_t count : counts) {
+        populate_backups(opts.dir, count);
+
+        /* 构造：扫描目录并建立备份目录，不删除任何文件 */
+        auto start = bench_clock::now();
+        auto sink = std::make_shared<spdlog::sinks::rotating_dately_file_sink_mt>(
+            opts.dir + "/app.log", max_age, 1024 * 1024, 0);
+        double startup = seconds_since(start);
+
+        /* 清理：按数量删除一个最旧的备份 */
+        start = bench_clock::now();
+        sink->set_max_files(count - 1);
+        double retention = seconds_since(start);
+
+        /* 轮转（含登记备份和按数量清理） */
+        spdlog::logger logger("bench", sink);
+        sink->set_max_size(64);
+        start = bench_clock::now();
+        logger.info("{}", payload);
+        logger.info("{}", payload);
+        double rotation = seconds_since(start);
+
+        /* 使用备份清单启动：第一次构造时建立清单，第二次计时 */
+        sink.reset();
+        populate_backups(opts.dir, count);
+        std::make_shared<spdlog::sinks::rotating_dately_file_sink_mt>(
+            opts.dir + "/app.log", max_age, 1024 * 1024, 0, false, spdlog::file_event_handlers{},
+            true);
+        start = bench_clock::now();
+        sink = std::make_shared<spdlog::sinks::rotating_dately_file_sink_mt>(
+            opts.dir + "/app.log", max_age, 1024 * 1024, 0, false, spdlog::file_event_handlers{},
+            true);
+        double manifest_startup = seconds_since(start);
+
+        result r{"retention", "dately", {}};
+        r.add("backups", static_cast<double>(count));
+        r.add("startup_seconds", startup);
+        r.add("manifest_startup_seconds", manifest_startup);
+        r.add("set_max_files_seconds", retention);
+        r.add("rotate_seconds", rotation);
+        results.push_back(r);
+        std::fprintf(stderr,
+                     "retention  %-18s backups=%-7zu startup=%.6fs manifest_startup=%.6fs "
+                     "set_max_files=%.6fs rotate=%.6fs\n",
+                     "dately", count, startup, manifest_startup, retention, rotation);
+    }
+    clear_directory(opts.dir);
+}
+
+void write_json(std::ostream &out, const options &opts) {
+    out << "{\n  \"dir\": \"" << opts.dir << "\",\n  \"timestamp\": " << std::time(nullptr)
+        << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const result &r = results[i];
+        out << "    {\"scenario\": \"" << r.scenario << "\", \"sink\": \"" << r.sink << "\"";
+        for (const auto &field : r.fields) {
+            out << ", \"" << field.first << "\": " << field.second;
+        }
+        out << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    out << "  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            opts.dir = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            opts.json_file = argv[++i];
+        } else if (arg == "--quick") {
+            opts.quick = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--dir <dir>] [--json <file>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        bench_throughput(opts);
+        bench_latency(opts);
+        bench_rotation_storm(opts);
+        bench_retention(opts);
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "dately_bench: %s\n", ex.what());
+        return 1;
+    }
+
+    if (opts.json_file.empty()) {
+        write_json(std::cout, opts);
+    } else {
+        std::ofstream out(opts.json_file);
+        write_json(out, opts);
+    }
+    return 0;
+}
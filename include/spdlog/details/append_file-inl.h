@@ -0,0 +1,85 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/append_file.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <cerrno>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE append_file::append_file(const filename_t &filename)
+    : filename_(filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), FILE_APPEND_DATA,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw_spdlog_ex("append_file: failed opening " + os::filename_to_str(filename),
+                        static_cast<int>(GetLastError()));
+    }
+    file_ = file;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size)) {
+        offset_ = static_cast<std::size_t>(size.QuadPart);
+    }
+#else
+    fd_ = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw_spdlog_ex("append_file: failed opening " + os::filename_to_str(filename), errno);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) == 0) {
+        offset_ = static_cast<std::size_t>(st.st_size);
+    }
+#endif
+}
+
+SPDLOG_INLINE append_file::~append_file() {
+#ifdef _WIN32
+    CloseHandle(file_);
+#else
+    ::close(fd_);
+#endif
+}
+
+SPDLOG_INLINE void append_file::write(const char *data, std::size_t size) {
+    std::size_t remaining = size;
+    while (remaining != 0) {
+#ifdef _WIN32
+        DWORD written = 0;
+        if (!WriteFile(file_, data, static_cast<DWORD>(remaining), &written, NULL)) {
+            throw_spdlog_ex("append_file: failed writing to " + os::filename_to_str(filename_),
+                            static_cast<int>(GetLastError()));
+        }
+#else
+        ssize_t written = ::write(fd_, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_spdlog_ex("append_file: failed writing to " + os::filename_to_str(filename_),
+                            errno);
+        }
+#endif
+        data += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+    offset_ += size;
+}
+
+SPDLOG_INLINE std::size_t append_file::offset() const { return offset_; }
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 以追加方式打开的文件句柄，绕过stdio：每次write是一次系统调用（被信号打断或部分写入时继续），
+ * 供合并写把整块缓冲区一次写出；与file_helper打开同一个文件，用于写入时file_helper只负责打开/关闭
+ */
+class append_file {
+public:
+    explicit append_file(const filename_t &filename);
+    ~append_file();
+
+    append_file(const append_file &) = delete;
+    append_file &operator=(const append_file &) = delete;
+
+    void write(const char *data, std::size_t size); /* 失败时抛出异常 */
+    std::size_t offset() const;                     /* 已交给内核的文件末尾位置 */
+
+private:
+    filename_t filename_;
+    std::size_t offset_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "append_file-inl.h"
+#endif
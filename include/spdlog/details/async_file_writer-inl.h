@@ -0,0 +1,460 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/async_file_writer.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(SPDLOG_DATELY_IO_URING) && defined(__linux__)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+/* 写入目标文件，各缓冲区按偏移写入，不使用O_APPEND */
+struct async_file_writer::target {
+    explicit target(const filename_t &name)
+        : filename(name) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(name.c_str(), GENERIC_WRITE,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                  OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw_spdlog_ex("async_file_writer: failed opening " + os::filename_to_str(name),
+                            static_cast<int>(GetLastError()));
+        }
+        handle = file;
+#else
+        fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw_spdlog_ex("async_file_writer: failed opening " + os::filename_to_str(name),
+                            errno);
+        }
+#endif
+    }
+
+    ~target() {
+#ifdef _WIN32
+        CloseHandle(handle);
+#else
+        ::close(fd);
+#endif
+    }
+
+    std::uint64_t size() const {
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        return GetFileSizeEx(handle, &size) ? static_cast<std::uint64_t>(size.QuadPart) : 0;
+#else
+        struct stat st;
+        return ::fstat(fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+#endif
+    }
+
+    filename_t filename;
+#ifdef _WIN32
+    void *handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+#if defined(SPDLOG_DATELY_IO_URING) && defined(__linux__)
+
+/* 最小的io_uring封装（不依赖liburing）：只由I/O线程使用，一次提交一批写入并等待全部完成 */
+struct async_file_writer::uring {
+    struct write_op {
+        int fd;
+        const char *data;
+        unsigned size;
+        std::uint64_t offset;
+        unsigned buf_index;
+    };
+
+    ~uring() {
+        if (sqes != nullptr) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring != nullptr && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != nullptr) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool init(unsigned entries, char *buffers, std::size_t buffer_size, std::size_t count) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+        if (fd < 0) {
+            return false;
+        }
+
+        sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+        sq_ring = map_(sq_ring_size, IORING_OFF_SQ_RING);
+        if (sq_ring == nullptr) {
+            return false;
+        }
+        cq_ring = single_mmap ? sq_ring : map_(cq_ring_size, IORING_OFF_CQ_RING);
+        sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(map_(sqes_size, IORING_OFF_SQES));
+        if (cq_ring == nullptr || sqes == nullptr) {
+            return false;
+        }
+
+        char *sq = static_cast<char *>(sq_ring);
+        sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        char *cq = static_cast<char *>(cq_ring);
+        cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+        /* 注册固定缓冲区（受RLIMIT_MEMLOCK限制），失败时使用普通写操作 */
+        std::vector<iovec> iov(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            iov[i].iov_base = buffers + i * buffer_size;
+            iov[i].iov_len = buffer_size;
+        }
+        fixed_buffers = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iov.data(),
+                                static_cast<unsigned>(count)) == 0;
+        return true;
+    }
+
+    /* 提交并等待全部完成，results[i]为第i个写入的返回值；io_uring本身出错时返回false */
+    bool run(const std::vector<write_op> &ops, std::vector<int> &results) {
+        unsigned tail = *sq_tail;
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            unsigned idx = tail & sq_mask;
+            io_uring_sqe &sqe = sqes[idx];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = fixed_buffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            sqe.fd = ops[i].fd;
+            sqe.addr = reinterpret_cast<std::uint64_t>(ops[i].data);
+            sqe.len = ops[i].size;
+            sqe.off = ops[i].offset;
+            sqe.buf_index = static_cast<std::uint16_t>(ops[i].buf_index);
+            sqe.user_data = i;
+            sq_array[idx] = idx;
+            ++tail;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        auto pending = static_cast<unsigned>(ops.size());
+        unsigned completed = 0;
+        results.assign(ops.size(), 0);
+        while (completed < ops.size()) {
+            long r = syscall(__NR_io_uring_enter, fd, pending, 1, IORING_ENTER_GETEVENTS, nullptr,
+                             0);
+            if (r < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                return false;
+            }
+            if (r > 0) {
+                pending -= static_cast<unsigned>(r);
+            }
+
+            unsigned head = *cq_head;
+            unsigned ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != ready; ++head) {
+                const io_uring_cqe &cqe = cqes[head & cq_mask];
+                results[static_cast<std::size_t>(cqe.user_data)] = cqe.res;
+                ++completed;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+    void *map_(std::size_t size, off_t offset) {
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    int fd = -1;
+    void *sq_ring = nullptr;
+    std::size_t sq_ring_size = 0;
+    void *cq_ring = nullptr;
+    std::size_t cq_ring_size = 0;
+    io_uring_sqe *sqes = nullptr;
+    std::size_t sqes_size = 0;
+    unsigned *sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned *sq_array = nullptr;
+    unsigned *cq_head = nullptr;
+    unsigned *cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe *cqes = nullptr;
+    bool fixed_buffers = false;
+};
+
+#else
+
+struct async_file_writer::uring {};
+
+#endif
+
+SPDLOG_INLINE async_file_writer::async_file_writer(std::size_t buffer_size,
+                                                   std::size_t buffer_count,
+                                                   bool drop_on_overflow)
+    : buffer_size_(buffer_size),
+      buffer_count_(buffer_count),
+      drop_on_overflow_(drop_on_overflow) {
+    if (buffer_size == 0 || buffer_count == 0) {
+        throw_spdlog_ex("async_file_writer: buffer_size and buffer_count cannot be zero");
+    }
+    buffers_.reset(new char[buffer_size * buffer_count]);
+    for (std::size_t i = buffer_count; i > 0; --i) {
+        free_.push_back(i - 1);
+    }
+    fill_.size = 0;
+
+#if defined(SPDLOG_DATELY_IO_URING) && defined(__linux__)
+    uring_.reset(new uring());
+    if (!uring_->init(static_cast<unsigned>(buffer_count), buffers_.get(), buffer_size,
+                      buffer_count)) {
+        uring_.reset();
+    }
+    uring_active_.store(uring_ != nullptr);
+#endif
+    thread_ = std::thread(&async_file_writer::io_loop_, this);
+}
+
+SPDLOG_INLINE async_file_writer::~async_file_writer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    io_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+SPDLOG_INLINE void async_file_writer::open(const filename_t &filename) {
+    std::shared_ptr<target> file = std::make_shared<target>(filename);
+    std::uint64_t size = file->size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    /* 未写满的缓冲区属于旧文件，先交给I/O线程 */
+    if (filling_) {
+        if (fill_.size > 0) {
+            ready_.push_back(fill_);
+            io_cv_.notify_one();
+        } else {
+            free_.push_back(fill_.index);
+        }
+        filling_ = false;
+    }
+    file_ = std::move(file);
+    file_offset_ = size;
+}
+
+SPDLOG_INLINE bool async_file_writer::write(const char *data, std::size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!file_) {
+        throw_spdlog_ex("async_file_writer: no file opened");
+    }
+    bool wake = ready_.empty() && !(filling_ && fill_.size > 0);
+
+    /* 丢弃模式下整条数据放不下就全部丢弃，不写出半条记录 */
+    if (drop_on_overflow_) {
+        std::size_t room = free_.size() * buffer_size_ + (filling_ ? buffer_size_ - fill_.size : 0);
+        if (room < size) {
+            dropped_bytes_.fetch_add(size, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    while (size > 0) {
+        if (!filling_) {
+            free_cv_.wait(lock, [this] { return !free_.empty(); });
+            fill_.index = free_.back();
+            fill_.size = 0;
+            fill_.offset = file_offset_;
+            fill_.file = file_;
+            free_.pop_back();
+            filling_ = true;
+        }
+        std::size_t n = std::min(size, buffer_size_ - fill_.size);
+        std::memcpy(buffer_(fill_.index) + fill_.size, data, n);
+        fill_.size += n;
+        file_offset_ += n;
+        queued_bytes_ += n;
+        data += n;
+        size -= n;
+        if (fill_.size == buffer_size_) {
+            ready_.push_back(fill_);
+            filling_ = false;
+            wake = true;
+        }
+    }
+    if (wake) {
+        io_cv_.notify_one();
+    }
+    return true;
+}
+
+SPDLOG_INLINE void async_file_writer::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::uint64_t target_bytes = queued_bytes_;
+    ++drain_requests_;
+    io_cv_.notify_one();
+    drain_cv_.wait(lock, [this, target_bytes] { return written_bytes_ >= target_bytes; });
+    --drain_requests_;
+}
+
+SPDLOG_INLINE bool async_file_writer::using_io_uring() const {
+    return uring_active_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE bool async_file_writer::drop_on_overflow() const {
+    return drop_on_overflow_;
+}
+
+SPDLOG_INLINE std::size_t async_file_writer::dropped_bytes() const {
+    return dropped_bytes_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE char *async_file_writer::buffer_(std::size_t index) {
+    return buffers_.get() + index * buffer_size_;
+}
+
+SPDLOG_INLINE void async_file_writer::io_loop_() {
+    std::vector<chunk> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            /* 只有未写满的缓冲区时最多等待1ms，让日志线程继续填充 */
+            const auto max_delay = std::chrono::milliseconds(1);
+            while (ready_.empty() && !stop_) {
+                if (!(filling_ && fill_.size > 0)) {
+                    io_cv_.wait(lock);
+                } else if (drain_requests_ > 0 ||
+                           io_cv_.wait_for(lock, max_delay) == std::cv_status::timeout) {
+                    break;
+                }
+            }
+            /* 取走未写满的缓冲区，生产者之后换用新的缓冲区继续写 */
+            batch.assign(ready_.begin(), ready_.end());
+            ready_.clear();
+            if (filling_ && fill_.size > 0) {
+                batch.push_back(fill_);
+                filling_ = false;
+            }
+            if (batch.empty()) {
+                return; /* stop_且已写完 */
+            }
+        }
+
+        write_batch_(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &c : batch) {
+                free_.push_back(c.index);
+                written_bytes_ += c.size;
+            }
+        }
+        free_cv_.notify_all();
+        drain_cv_.notify_all();
+        batch.clear();
+    }
+}
+
+/* 批量写入：io_uring可用时一次提交整批，短写和失败的部分用pwrite补写（按偏移写入，重复写无害） */
+SPDLOG_INLINE void async_file_writer::write_batch_(std::vector<chunk> &batch) {
+#if defined(SPDLOG_DATELY_IO_URING) && defined(__linux__)
+    if (uring_) {
+        std::vector<uring::write_op> ops;
+        ops.reserve(batch.size());
+        for (auto &c : batch) {
+            ops.push_back({c.file->fd, buffer_(c.index), static_cast<unsigned>(c.size), c.offset,
+                           static_cast<unsigned>(c.index)});
+        }
+        std::vector<int> results;
+        if (uring_->run(ops, results)) {
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                std::size_t done = results[i] > 0 ? static_cast<std::size_t>(results[i]) : 0;
+                if (done < batch[i].size) {
+                    write_chunk_(batch[i], done);
+                }
+            }
+            return;
+        }
+        std::fprintf(stderr, "[*** LOG ERROR ***] async_file_writer: io_uring failed (%d), "
+                             "falling back to pwrite\n", errno);
+        uring_.reset();
+        uring_active_.store(false, std::memory_order_relaxed);
+    }
+#endif
+    for (auto &c : batch) {
+        write_chunk_(c, 0);
+    }
+}
+
+SPDLOG_INLINE void async_file_writer::write_chunk_(const chunk &c, std::size_t done) {
+    const char *data = buffer_(c.index);
+    while (done < c.size) {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {};
+        std::uint64_t offset = c.offset + done;
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD n = 0;
+        if (!WriteFile(c.file->handle, data + done, static_cast<DWORD>(c.size - done), &n,
+                       &overlapped)) {
+            std::fprintf(stderr, "[*** LOG ERROR ***] async_file_writer: failed writing %s (%lu)\n",
+                         os::filename_to_str(c.file->filename).c_str(), GetLastError());
+            return;
+        }
+#else
+        ssize_t n = ::pwrite(c.file->fd, data + done, c.size - done,
+                             static_cast<off_t>(c.offset + done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::fprintf(stderr, "[*** LOG ERROR ***] async_file_writer: failed writing %s (%d)\n",
+                         os::filename_to_str(c.file->filename).c_str(), errno);
+            return;
+        }
+#endif
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
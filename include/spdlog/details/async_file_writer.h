@@ -0,0 +1,95 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 异步文件写入：日志线程把数据复制到内存缓冲区后立即返回，由专用I/O线程按偏移写到文件，
+ * 磁盘卡顿时只阻塞I/O线程；未写满的缓冲区最多停留1ms后由I/O线程取走写出（drain()时立即取走），
+ * 日志线程只在缓冲区写满或有新数据可取时唤醒I/O线程
+ * 缓冲区个数有界（即在途写入的上限），全部在途时write()阻塞，或按设置丢弃整条数据并计数
+ *
+ * 定义SPDLOG_DATELY_IO_URING后（Linux，只需要内核头文件）I/O线程通过io_uring批量提交写入，
+ * 缓冲区注册为固定缓冲区（注册失败时退回普通写操作）；
+ * io_uring不可用时（未定义、内核版本或seccomp限制）退回pwrite
+ * 写入失败时在stderr输出错误信息，I/O线程继续运行
+ */
+class async_file_writer {
+public:
+    explicit async_file_writer(std::size_t buffer_size = 256 * 1024,
+                               std::size_t buffer_count = 8,
+                               bool drop_on_overflow = false);
+    ~async_file_writer(); /* 写完剩余数据后退出 */
+
+    async_file_writer(const async_file_writer &) = delete;
+    async_file_writer &operator=(const async_file_writer &) = delete;
+
+    /* 切换到新文件，从文件末尾开始写；之前提交的数据仍写到旧文件
+       新文件不能是仍有数据在途的同一个文件（调用方先drain()） */
+    void open(const filename_t &filename);
+    bool write(const char *data, std::size_t size); /* 丢弃时返回false */
+    void drain(); /* 等待此前提交的数据全部写完 */
+
+    bool using_io_uring() const;
+    bool drop_on_overflow() const;
+    std::size_t dropped_bytes() const;
+
+private:
+    struct target;
+    struct uring;
+
+    struct chunk {
+        std::size_t index; /* 缓冲区序号（io_uring固定缓冲区序号） */
+        std::size_t size;
+        std::uint64_t offset;
+        std::shared_ptr<target> file;
+    };
+
+    char *buffer_(std::size_t index);
+    void io_loop_();
+    void write_batch_(std::vector<chunk> &batch);
+    void write_chunk_(const chunk &c, std::size_t done);
+
+    std::size_t buffer_size_;
+    std::size_t buffer_count_;
+    bool drop_on_overflow_;
+    std::unique_ptr<char[]> buffers_;
+    std::unique_ptr<uring> uring_; /* 只由I/O线程访问（构造时除外） */
+    std::atomic<bool> uring_active_{false};
+
+    std::mutex mutex_;
+    std::condition_variable io_cv_;    /* 通知I/O线程有数据 */
+    std::condition_variable free_cv_;  /* 通知生产者有空闲缓冲区 */
+    std::condition_variable drain_cv_; /* 通知drain()有写入完成 */
+    std::vector<std::size_t> free_;
+    std::deque<chunk> ready_;
+    bool filling_ = false;
+    chunk fill_;                      /* 正在填充的缓冲区，filling_为true时有效 */
+    std::shared_ptr<target> file_;    /* 当前文件 */
+    std::uint64_t file_offset_ = 0;   /* 当前文件的下一个写入位置 */
+    std::uint64_t queued_bytes_ = 0;  /* 已提交的字节数（单调递增） */
+    std::uint64_t written_bytes_ = 0; /* 已写完（或写入失败）的字节数 */
+    std::atomic<std::size_t> dropped_bytes_{0};
+    std::size_t drain_requests_ = 0;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "async_file_writer-inl.h"
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/backup_catalog.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void backup_catalog::clear() {
+    files_.clear();
+    total_size_ = 0;
+}
+
+SPDLOG_INLINE void backup_catalog::add(backup_file file) {
+    /* 同名备份（旧格式的文件名只精确到秒，同一秒内轮转会覆盖）只保留一条记录 */
+    if (!files_.empty() && files_.back().filename == file.filename) {
+        total_size_ = total_size_ - files_.back().size + file.size;
+        files_.back() = std::move(file);
+        return;
+    }
+    total_size_ += file.size;
+
+    /* 正常轮转产生的备份总是最新的，直接追加 */
+    if (files_.empty() || !backup_older(file, files_.back())) {
+        files_.push_back(std::move(file));
+        return;
+    }
+
+    /* 时间乱序（如系统时间回拨）时按时间插入，保持有序 */
+    auto pos = std::upper_bound(files_.begin(), files_.end(), file, backup_older);
+    files_.insert(pos, std::move(file));
+}
+
+SPDLOG_INLINE void backup_catalog::pop_oldest() {
+    total_size_ -= files_.front().size;
+    files_.pop_front();
+}
+
+SPDLOG_INLINE bool backup_catalog::replace(const filename_t &filename,
+                                           const filename_t &new_filename,
+                                           std::size_t new_size) {
+    /* 刚轮转出的备份在末尾附近，从新到旧查找 */
+    for (auto it = files_.rbegin(); it != files_.rend(); ++it) {
+        if (it->filename == filename) {
+            total_size_ = total_size_ - it->size + new_size;
+            it->filename = new_filename;
+            it->size = new_size;
+            return true;
+        }
+    }
+    return false;
+}
+
+SPDLOG_INLINE const backup_file *backup_catalog::find(const filename_t &filename) const {
+    for (auto it = files_.rbegin(); it != files_.rend(); ++it) {
+        if (it->filename == filename) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+SPDLOG_INLINE const backup_file &backup_catalog::oldest() const {
+    return files_.front();
+}
+
+SPDLOG_INLINE bool backup_catalog::empty() const {
+    return files_.empty();
+}
+
+SPDLOG_INLINE std::size_t backup_catalog::size() const {
+    return files_.size();
+}
+
+SPDLOG_INLINE const std::deque<backup_file> &backup_catalog::files() const {
+    return files_;
+}
+
+SPDLOG_INLINE std::size_t backup_catalog::total_size() const {
+    return total_size_;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+
+namespace spdlog {
+namespace details {
+
+/* 备份文件记录：文件名、备份时间（解析一次后缓存）、大小（未知时为0）和轮转序号（旧格式为0） */
+struct backup_file {
+    filename_t filename;
+    std::time_t time;
+    std::size_t size;
+    std::uint64_t sequence;
+};
+
+/* 备份的先后顺序：按时间，同一秒内按轮转序号 */
+inline bool backup_older(const backup_file &a, const backup_file &b) {
+    return a.time < b.time || (a.time == b.time && a.sequence < b.sequence);
+}
+
+/*
+ * 按时间（同一秒内按轮转序号）排序的备份文件目录（最旧的在前）
+ * 构造sink时扫描目录填充一次，之后由rotate_()增量维护，
+ * 按数量/按时间的清理只需弹出队首，不再遍历目录和解析文件名
+ */
+class backup_catalog {
+public:
+    backup_catalog() = default;
+
+    void clear();
+    void add(backup_file file); /* 按时间和序号插入，新文件追加到末尾为O(1) */
+    void pop_oldest();
+
+    /* 备份被处理（如压缩）后更新文件名和大小，条目已被清理时返回false */
+    bool replace(const filename_t &filename, const filename_t &new_filename, std::size_t new_size);
+
+    const backup_file &oldest() const;
+    const backup_file *find(const filename_t &filename) const;
+    bool empty() const;
+    std::size_t size() const;
+    const std::deque<backup_file> &files() const;
+    std::size_t total_size() const; /* 全部备份的总字节数（增量维护） */
+
+private:
+    std::deque<backup_file> files_;
+    std::size_t total_size_ = 0;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "backup_catalog-inl.h"
+#endif
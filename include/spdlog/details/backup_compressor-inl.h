@@ -0,0 +1,218 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/backup_compressor.h>
+#endif
+
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+#include <zlib.h>
+#ifdef SPDLOG_DATELY_ZSTD
+    #include <zstd.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE backup_compressor::backup_compressor(
+    codec compression, int level, std::size_t max_jobs, int nice, bool idle_io)
+    : codec_(compression),
+      level_(level),
+      nice_(nice),
+      idle_io_(idle_io) {
+#ifndef SPDLOG_DATELY_ZSTD
+    if (compression == codec::zstd) {
+        throw_spdlog_ex("backup_compressor: zstd support requires SPDLOG_DATELY_ZSTD");
+    }
+#endif
+    if (max_jobs == 0) {
+        throw_spdlog_ex("backup_compressor: max_jobs arg cannot be zero");
+    }
+    for (std::size_t i = 0; i < max_jobs; ++i) {
+        threads_.emplace_back(&backup_compressor::worker_loop_, this);
+    }
+}
+
+SPDLOG_INLINE backup_compressor::~backup_compressor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    push_cv_.notify_all();
+    for (auto &t : threads_) {
+        t.join();
+    }
+}
+
+SPDLOG_INLINE void backup_compressor::process(const filename_t &backup, done_callback done) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.emplace_back(backup, std::move(done));
+        ++pending_;
+    }
+    push_cv_.notify_one();
+}
+
+SPDLOG_INLINE void backup_compressor::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+SPDLOG_INLINE const char *backup_compressor::extension(codec compression) {
+    return compression == codec::zstd ? ".zst" : ".gz";
+}
+
+SPDLOG_INLINE void backup_compressor::worker_loop_() {
+    lower_priority_();
+
+    for (;;) {
+        std::pair<filename_t, done_callback> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            push_cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        filename_t dst = job.first + extension(codec_);
+        try {
+            if (compress_file_(job.first, dst)) {
+                std::FILE *out = std::fopen(dst.c_str(), "rb");
+                long size = 0;
+                if (out != nullptr) {
+                    std::fseek(out, 0, SEEK_END);
+                    size = std::ftell(out);
+                    std::fclose(out);
+                }
+                job.second(dst, static_cast<std::size_t>(size < 0 ? 0 : size));
+            }
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "[*** LOG ERROR ***] backup_compressor: %s\n", ex.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+/* 降低压缩线程的CPU和IO优先级（Linux下setpriority/ioprio_set作用于单个线程） */
+SPDLOG_INLINE void backup_compressor::lower_priority_() {
+#ifdef __linux__
+    auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    if (nice_ != 0) {
+        ::setpriority(PRIO_PROCESS, tid, nice_);
+    }
+    #ifdef SYS_ioprio_set
+    if (idle_io_) {
+        const int ioprio_who_process = 1;
+        const int ioprio_class_idle = 3;
+        ::syscall(SYS_ioprio_set, ioprio_who_process, static_cast<int>(tid),
+                  ioprio_class_idle << 13);
+    }
+    #endif
+#else
+    (void)nice_;
+    (void)idle_io_;
+#endif
+}
+
+/* 压缩到临时文件，完成后改名为目标文件并删除原文件 */
+SPDLOG_INLINE bool backup_compressor::compress_file_(const filename_t &src, const filename_t &dst) {
+    std::FILE *in = std::fopen(src.c_str(), "rb");
+    if (in == nullptr) {
+        return false; /* 已被清理或外部删除 */
+    }
+
+    filename_t tmp = dst + SPDLOG_FILENAME_T(".tmp");
+    bool ok;
+#ifdef SPDLOG_DATELY_ZSTD
+    if (codec_ == codec::zstd) {
+        ok = compress_zstd_(in, tmp);
+    } else {
+        ok = compress_gzip_(in, tmp);
+    }
+#else
+    ok = compress_gzip_(in, tmp);
+#endif
+    std::fclose(in);
+
+    if (!ok || std::rename(tmp.c_str(), dst.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    std::remove(src.c_str());
+    return true;
+}
+
+SPDLOG_INLINE bool backup_compressor::compress_gzip_(std::FILE *in, const filename_t &dst) {
+    char mode[16];
+    std::snprintf(mode, sizeof(mode), "wb%d", level_ < 0 ? 6 : (level_ > 9 ? 9 : level_));
+    gzFile out = gzopen(dst.c_str(), mode);
+    if (out == nullptr) {
+        return false;
+    }
+
+    std::vector<char> buf(128 * 1024);
+    bool ok = true;
+    std::size_t n;
+    while (ok && (n = std::fread(buf.data(), 1, buf.size(), in)) > 0) {
+        ok = gzwrite(out, buf.data(), static_cast<unsigned>(n)) == static_cast<int>(n);
+    }
+    ok = !std::ferror(in) && ok;
+    return gzclose(out) == Z_OK && ok;
+}
+
+#ifdef SPDLOG_DATELY_ZSTD
+SPDLOG_INLINE bool backup_compressor::compress_zstd_(std::FILE *in, const filename_t &dst) {
+    std::FILE *out = std::fopen(dst.c_str(), "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level_);
+
+    std::vector<char> in_buf(ZSTD_CStreamInSize());
+    std::vector<char> out_buf(ZSTD_CStreamOutSize());
+    bool ok = true;
+    for (;;) {
+        std::size_t n = std::fread(in_buf.data(), 1, in_buf.size(), in);
+        bool last = n < in_buf.size();
+        ZSTD_EndDirective mode = last ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input = {in_buf.data(), n, 0};
+        bool finished;
+        do {
+            ZSTD_outBuffer output = {out_buf.data(), out_buf.size(), 0};
+            std::size_t remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+            if (ZSTD_isError(remaining) ||
+                std::fwrite(out_buf.data(), 1, output.pos, out) != output.pos) {
+                ok = false;
+                break;
+            }
+            finished = last ? (remaining == 0) : (input.pos == input.size);
+        } while (!finished);
+        if (!ok || last) {
+            break;
+        }
+    }
+    ok = !std::ferror(in) && ok;
+    ZSTD_freeCCtx(cctx);
+    return std::fclose(out) == 0 && ok;
+}
+#endif
+
+}  // namespace details
+}  // namespace spdlog
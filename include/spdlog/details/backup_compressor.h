@@ -0,0 +1,73 @@
+#pragma once
+
+#include "spdlog/details/backup_processor.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * 依赖zlib（gzip）；定义SPDLOG_DATELY_ZSTD后支持zstd（需要链接libzstd）
+ */
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 备份压缩：在低优先级的后台线程中把备份压缩为 "<备份>.gz" / "<备份>.zst"，
+ * 先写临时文件再改名，成功后删除原文件
+ * max_jobs限制同时进行的压缩数（线程数），nice为线程的CPU优先级，
+ * idle_io为true时在Linux上把线程的IO优先级设为idle
+ */
+class backup_compressor final : public backup_processor {
+public:
+    enum class codec { gzip, zstd };
+
+    explicit backup_compressor(codec compression = codec::gzip,
+                               int level = 6,
+                               std::size_t max_jobs = 1,
+                               int nice = 10,
+                               bool idle_io = true);
+    ~backup_compressor() override; /* 完成队列中剩余的压缩后退出 */
+
+    backup_compressor(const backup_compressor &) = delete;
+    backup_compressor &operator=(const backup_compressor &) = delete;
+
+    void process(const filename_t &backup, done_callback done) override;
+    void wait_idle() override;
+
+    static const char *extension(codec compression);
+
+private:
+    void worker_loop_();
+    void lower_priority_();
+    bool compress_file_(const filename_t &src, const filename_t &dst);
+    bool compress_gzip_(std::FILE *in, const filename_t &dst);
+#ifdef SPDLOG_DATELY_ZSTD
+    bool compress_zstd_(std::FILE *in, const filename_t &dst);
+#endif
+
+    codec codec_;
+    int level_;
+    int nice_;
+    bool idle_io_;
+
+    std::mutex mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::pair<filename_t, done_callback>> jobs_;
+    std::size_t pending_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "backup_compressor-inl.h"
+#endif
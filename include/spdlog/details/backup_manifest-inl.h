@@ -0,0 +1,227 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/backup_manifest.h>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+namespace manifest_detail {
+
+static const char Magic[] = {'D', 'T', 'L', 'Y', 'M', 'A', 'N', '1'};
+static const std::size_t MagicSize = sizeof(Magic);
+/* 操作 + 时间 + 大小 + 文件名长度 */
+static const std::size_t HeaderSize = 1 + 8 + 8 + 2;
+
+inline std::uint32_t fnv1a(const char *data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline void put_le(std::string &out, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+inline std::uint64_t get_le(const char *data, std::size_t bytes) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+}  // namespace manifest_detail
+
+SPDLOG_INLINE backup_manifest::backup_manifest(filename_t manifest_filename, filename_t directory)
+    : manifest_filename_(std::move(manifest_filename)),
+      directory_(std::move(directory)) {}
+
+SPDLOG_INLINE backup_manifest::~backup_manifest() {
+    if (fd_ != nullptr) {
+        std::fclose(fd_);
+    }
+}
+
+SPDLOG_INLINE bool backup_manifest::load(std::vector<backup_file> &files) {
+    using namespace manifest_detail;
+
+    std::FILE *in = std::fopen(manifest_filename_.c_str(), "rb");
+    if (in == nullptr) {
+        return false;
+    }
+
+    /* 一次读入整个清单 */
+    std::string data;
+    char chunk[64 * 1024];
+    std::size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.append(chunk, n);
+    }
+    std::fclose(in);
+
+    if (data.size() < MagicSize || !std::equal(Magic, Magic + MagicSize, data.begin())) {
+        return false;
+    }
+
+    /* 重放添加/删除记录 */
+    std::map<filename_t, backup_file> live;
+    std::size_t records = 0;
+    std::size_t pos = MagicSize;
+    while (pos + HeaderSize <= data.size()) {
+        const char *record = data.data() + pos;
+        auto op = static_cast<std::uint8_t>(record[0]);
+        auto time = static_cast<std::int64_t>(get_le(record + 1, 8));
+        auto size = get_le(record + 9, 8);
+        auto name_len = static_cast<std::size_t>(get_le(record + 17, 2));
+        std::size_t record_size = HeaderSize + name_len + 4;
+        if (pos + record_size > data.size() ||
+            fnv1a(record, HeaderSize + name_len) !=
+                static_cast<std::uint32_t>(get_le(record + HeaderSize + name_len, 4))) {
+            break; /* 写入时崩溃留下的不完整记录 */
+        }
+
+        filename_t name(record + HeaderSize, name_len);
+        filename_t path = directory_.empty() ? name : directory_ + "/" + name;
+        if (op == OpAdd) {
+            /* 清单不记录轮转序号，由调用方按文件名补上 */
+            live[path] = backup_file{path, static_cast<std::time_t>(time),
+                                     static_cast<std::size_t>(size), 0};
+        } else if (op == OpRemove) {
+            live.erase(path);
+        } else {
+            return false;
+        }
+        ++records;
+        pos += record_size;
+    }
+
+    files.clear();
+    files.reserve(live.size());
+    for (auto &entry : live) {
+        files.push_back(std::move(entry.second));
+    }
+    std::sort(files.begin(), files.end(),
+              [](const backup_file &a, const backup_file &b) { return a.time < b.time; });
+
+    /* 有残缺记录时重写，避免之后追加的记录被它挡住 */
+    records_ = records;
+    if (pos != data.size()) {
+        rewrite(std::deque<backup_file>(files.begin(), files.end()));
+    }
+    return true;
+}
+
+SPDLOG_INLINE void backup_manifest::append_add(const backup_file &file) {
+    append_record_(OpAdd, static_cast<std::int64_t>(file.time),
+                   static_cast<std::uint64_t>(file.size), file.filename);
+}
+
+SPDLOG_INLINE void backup_manifest::append_remove(const filename_t &filename) {
+    append_record_(OpRemove, 0, 0, filename);
+}
+
+SPDLOG_INLINE void backup_manifest::rewrite(const std::deque<backup_file> &files) {
+    using namespace manifest_detail;
+
+    std::string data(Magic, MagicSize);
+    for (const auto &file : files) {
+        encode_record_(data, OpAdd, static_cast<std::int64_t>(file.time),
+                       static_cast<std::uint64_t>(file.size), name_only_(file.filename));
+    }
+
+    if (fd_ != nullptr) {
+        std::fclose(fd_);
+        fd_ = nullptr;
+    }
+
+    filename_t tmp_filename = manifest_filename_ + SPDLOG_FILENAME_T(".tmp");
+    std::FILE *out = std::fopen(tmp_filename.c_str(), "wb");
+    if (out == nullptr) {
+        return;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), out) == data.size();
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) {
+        std::remove(tmp_filename.c_str());
+        return;
+    }
+    /* Windows下rename不能覆盖已存在的文件 */
+#ifdef _WIN32
+    std::remove(manifest_filename_.c_str());
+#endif
+    if (std::rename(tmp_filename.c_str(), manifest_filename_.c_str()) == 0) {
+        records_ = files.size();
+    }
+}
+
+SPDLOG_INLINE bool backup_manifest::needs_compaction(std::size_t live_files) const {
+    return records_ > 2 * live_files + 1024;
+}
+
+SPDLOG_INLINE void backup_manifest::append_record_(std::uint8_t op,
+                                                   std::int64_t time,
+                                                   std::uint64_t size,
+                                                   const filename_t &filename) {
+    if (!open_for_append_()) {
+        return;
+    }
+    std::string record;
+    encode_record_(record, op, time, size, name_only_(filename));
+    std::fwrite(record.data(), 1, record.size(), fd_);
+    std::fflush(fd_);
+    ++records_;
+}
+
+SPDLOG_INLINE void backup_manifest::encode_record_(std::string &out,
+                                                   std::uint8_t op,
+                                                   std::int64_t time,
+                                                   std::uint64_t size,
+                                                   const filename_t &filename) {
+    using namespace manifest_detail;
+
+    std::size_t start = out.size();
+    std::size_t name_len = std::min<std::size_t>(filename.size(), 0xffff);
+    out.push_back(static_cast<char>(op));
+    put_le(out, static_cast<std::uint64_t>(time), 8);
+    put_le(out, size, 8);
+    put_le(out, name_len, 2);
+    out.append(filename.data(), name_len);
+    put_le(out, fnv1a(out.data() + start, out.size() - start), 4);
+}
+
+SPDLOG_INLINE bool backup_manifest::open_for_append_() {
+    using namespace manifest_detail;
+
+    if (fd_ != nullptr) {
+        return true;
+    }
+    fd_ = std::fopen(manifest_filename_.c_str(), "ab");
+    if (fd_ == nullptr) {
+        return false;
+    }
+    /* 新建的清单先写魔数 */
+    std::fseek(fd_, 0, SEEK_END);
+    if (std::ftell(fd_) == 0) {
+        std::fwrite(Magic, 1, MagicSize, fd_);
+    }
+    return true;
+}
+
+SPDLOG_INLINE filename_t backup_manifest::name_only_(const filename_t &path) const {
+    size_t pos = path.find_last_of("/\\");
+    return pos == filename_t::npos ? path : path.substr(pos + 1);
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/backup_catalog.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 备份清单：追加写入的二进制索引（备份文件名、时间、大小），与日志文件放在同一目录
+ * 启动时一次读入即可恢复备份目录，避免遍历目录和解析文件名
+ *
+ * 文件格式：8字节魔数 "DTLYMAN1"，之后是若干条记录
+ *   u8 操作(1=添加, 2=删除) | i64 时间 | u64 大小 | u16 文件名长度 | 文件名 | u32 校验和(FNV-1a)
+ * 整数均为小端序，文件名不含目录
+ * 末尾不完整或校验失败的记录（写入时崩溃）会被忽略，魔数错误则视为损坏
+ */
+class backup_manifest {
+public:
+    explicit backup_manifest(filename_t manifest_filename, filename_t directory);
+    ~backup_manifest();
+
+    backup_manifest(const backup_manifest &) = delete;
+    backup_manifest &operator=(const backup_manifest &) = delete;
+
+    /* 读入清单，按时间排序后输出；清单不存在或损坏时返回false */
+    bool load(std::vector<backup_file> &files);
+
+    void append_add(const backup_file &file);
+    void append_remove(const filename_t &filename);
+
+    /* 用当前备份目录重写清单（先写临时文件再改名） */
+    void rewrite(const std::deque<backup_file> &files);
+
+    /* 删除记录累积过多时重写清单 */
+    bool needs_compaction(std::size_t live_files) const;
+
+private:
+    static constexpr std::uint8_t OpAdd = 1;
+    static constexpr std::uint8_t OpRemove = 2;
+
+    void append_record_(std::uint8_t op, std::int64_t time, std::uint64_t size,
+                        const filename_t &filename);
+    static void encode_record_(std::string &out,
+                               std::uint8_t op,
+                               std::int64_t time,
+                               std::uint64_t size,
+                               const filename_t &filename);
+    bool open_for_append_();
+    filename_t name_only_(const filename_t &path) const;
+
+    filename_t manifest_filename_;
+    filename_t directory_;
+    std::FILE *fd_ = nullptr;
+    std::size_t records_ = 0; /* 清单中的记录数（含删除记录） */
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "backup_manifest-inl.h"
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/backup_name.h>
+#endif
+
+#include <spdlog/details/os.h>
+#include <spdlog/fmt/fmt.h>
+
+#include <chrono>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+namespace backup_name_detail {
+
+inline bool read_digits(const filename_t &name, std::size_t pos, std::size_t count, int &value) {
+    value = 0;
+    for (std::size_t i = pos; i < pos + count; ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (name[i] - '0');
+    }
+    return true;
+}
+
+}  // namespace backup_name_detail
+
+SPDLOG_INLINE backup_name::backup_name(filename_t prefix)
+    : prefix_(std::move(prefix)) {
+    if (prefix_.find_first_of(SPDLOG_FILENAME_T("/\\")) != filename_t::npos) {
+        throw_spdlog_ex("backup_name: prefix cannot contain a directory");
+    }
+}
+
+SPDLOG_INLINE const filename_t &backup_name::prefix() const { return prefix_; }
+
+SPDLOG_INLINE filename_t backup_name::format(log_clock::time_point time,
+                                             std::uint64_t sequence,
+                                             const filename_t &suffix) const {
+    std::time_t seconds = log_clock::to_time_t(time);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                      time - log_clock::from_time_t(seconds))
+                      .count();
+    /* to_time_t可能向零或就近取整，微秒部分规整到[0, 1000000) */
+    if (micros < 0) {
+        --seconds;
+        micros += 1000000;
+    } else if (micros >= 1000000) {
+        ++seconds;
+        micros -= 1000000;
+    }
+    tm tm_info = os::localtime(seconds);
+    return fmt_lib::format(
+        SPDLOG_FILENAME_T("{}{:04d}{:02d}{:02d}_{:02d}{:02d}{:02d}_{:06d}_{:08d}.log{}"), prefix_,
+        tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday, tm_info.tm_hour,
+        tm_info.tm_min, tm_info.tm_sec, static_cast<long long>(micros), sequence, suffix);
+}
+
+SPDLOG_INLINE bool backup_name::parse(const filename_t &name,
+                                      backup_stamp &stamp,
+                                      std::size_t &suffix_pos) const {
+    using backup_name_detail::read_digits;
+
+    /* 前缀 + "YYYYmmdd_HHMMSS" + ".log" 至少19个字符 */
+    std::size_t pos = prefix_.size();
+    if (name.size() < pos + 19 || name.compare(0, pos, prefix_) != 0 || name[pos + 8] != '_') {
+        return false;
+    }
+    int year, month, day, hour, minute, second;
+    if (!read_digits(name, pos, 4, year) || !read_digits(name, pos + 4, 2, month) ||
+        !read_digits(name, pos + 6, 2, day) || !read_digits(name, pos + 9, 2, hour) ||
+        !read_digits(name, pos + 11, 2, minute) || !read_digits(name, pos + 13, 2, second)) {
+        return false;
+    }
+    pos += 15;
+
+    /* 新格式："_uuuuuu_" + 至少一位序号 */
+    int micros = 0;
+    std::uint64_t sequence = 0;
+    if (name[pos] == '_') {
+        if (name.size() < pos + 13 || !read_digits(name, pos + 1, 6, micros) ||
+            name[pos + 7] != '_') {
+            return false;
+        }
+        pos += 8;
+        std::size_t digits = 0;
+        while (pos < name.size() && name[pos] >= '0' && name[pos] <= '9' && digits < 19) {
+            sequence = sequence * 10 + static_cast<std::uint64_t>(name[pos] - '0');
+            ++pos;
+            ++digits;
+        }
+        if (digits == 0) {
+            return false;
+        }
+    }
+    if (name.compare(pos, 4, SPDLOG_FILENAME_T(".log")) != 0) {
+        return false;
+    }
+
+    std::tm tm_info = {};
+    tm_info.tm_year = year - 1900;
+    tm_info.tm_mon = month - 1;
+    tm_info.tm_mday = day;
+    tm_info.tm_hour = hour;
+    tm_info.tm_min = minute;
+    tm_info.tm_sec = second;
+    tm_info.tm_isdst = -1;
+    stamp.time = std::mktime(&tm_info);
+    stamp.micros = static_cast<std::uint32_t>(micros);
+    stamp.sequence = sequence;
+    suffix_pos = pos + 4;
+    return true;
+}
+
+}  // namespace details
+}  // namespace spdlog
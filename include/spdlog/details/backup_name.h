@@ -0,0 +1,47 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+namespace spdlog {
+namespace details {
+
+/* 备份文件名中的时间戳：秒（本地时间解析）、秒内微秒和轮转序号 */
+struct backup_stamp {
+    std::time_t time;
+    std::uint32_t micros;
+    std::uint64_t sequence;
+};
+
+/*
+ * 备份文件名："<前缀>YYYYmmdd_HHMMSS_uuuuuu_NNNNNNNN.log<后缀>"（本地时间、秒内微秒、轮转序号）
+ * 序号由sink单调递增（启动时从已有备份的最大序号继续），同一秒内多次轮转也不会重名，
+ * 同一秒内的备份按序号排序；旧格式 "<前缀>YYYYmmdd_HHMMSS.log<后缀>" 仍可解析（微秒和序号为0）
+ * 解析只读取定长的数字字段，不经过std::get_time和字符串流
+ */
+class backup_name {
+public:
+    explicit backup_name(filename_t prefix = SPDLOG_FILENAME_T("app_")); /* 前缀不能包含目录 */
+
+    const filename_t &prefix() const;
+
+    /* 生成不含目录的文件名，suffix接在".log"之后（如".zst"、".3"） */
+    filename_t format(log_clock::time_point time,
+                      std::uint64_t sequence,
+                      const filename_t &suffix = filename_t()) const;
+
+    /* 解析不含目录的文件名，成功时输出时间戳和".log"之后部分的起始位置 */
+    bool parse(const filename_t &name, backup_stamp &stamp, std::size_t &suffix_pos) const;
+
+private:
+    filename_t prefix_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "backup_name-inl.h"
+#endif
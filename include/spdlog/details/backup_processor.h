@@ -0,0 +1,26 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+#include <functional>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 轮转后处理阶段：对rotate_()产生的每个备份文件做进一步处理（如压缩）
+ * 处理完成后调用done(新文件名, 新文件大小)，sink据此更新备份目录；
+ * 处理失败时不调用done，备份保持原样
+ */
+class backup_processor {
+public:
+    using done_callback = std::function<void(const filename_t &result, std::size_t size)>;
+
+    virtual ~backup_processor() = default;
+
+    virtual void process(const filename_t &backup, done_callback done) = 0;
+    virtual void wait_idle() = 0; /* 阻塞直到已提交的处理全部完成 */
+};
+
+}  // namespace details
+}  // namespace spdlog
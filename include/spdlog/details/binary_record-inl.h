@@ -0,0 +1,285 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/binary_record.h>
+#endif
+
+#include <spdlog/details/mapped_file.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace spdlog {
+namespace details {
+
+namespace binary_record_detail {
+
+static const char Magic[] = {'D', 'T', 'L', 'Y', 'B', 'I', 'N', '1'};
+static const std::size_t MagicSize = sizeof(Magic);
+
+static const std::uint8_t TagLogger = 1;
+static const std::uint8_t TagSource = 2;
+static const std::uint8_t TagRecord = 3;
+static const std::uint8_t TagReset = 4;
+
+inline void put_varint(memory_buf_t &out, std::uint64_t value) {
+    char bytes[10];
+    std::size_t n = 0;
+    while (value >= 0x80) {
+        bytes[n++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    bytes[n++] = static_cast<char>(value);
+    out.append(bytes, bytes + n);
+}
+
+inline void put_string(memory_buf_t &out, const char *data, std::size_t size) {
+    put_varint(out, size);
+    out.append(data, data + size);
+}
+
+/* 读取varint，数据不完整时返回false */
+inline bool get_varint(const char *&p, const char *end, std::uint64_t &value) {
+    value = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        auto byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool get_string(const char *&p, const char *end, string_view_t &value) {
+    std::uint64_t size;
+    if (!get_varint(p, end, size) || size > static_cast<std::uint64_t>(end - p)) {
+        return false;
+    }
+    value = string_view_t(p, static_cast<std::size_t>(size));
+    p += size;
+    return true;
+}
+
+inline std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+}  // namespace binary_record_detail
+
+SPDLOG_INLINE void binary_record_encoder::write_header(memory_buf_t &out) {
+    using namespace binary_record_detail;
+    out.append(Magic, Magic + MagicSize);
+}
+
+SPDLOG_INLINE void binary_record_encoder::encode(const log_msg &msg, memory_buf_t &out) {
+    using namespace binary_record_detail;
+
+    /* 追加到已有文件时，之前的定义和时间基准对解码端仍然有效，先让解码端清空 */
+    if (pending_reset_) {
+        out.push_back(static_cast<char>(TagReset));
+        pending_reset_ = false;
+    }
+
+    /* 先写出本条记录用到的字符串定义 */
+    std::uint32_t logger = logger_id_(msg.logger_name, out);
+    std::uint32_t source = msg.source.empty() ? 0 : source_id_(msg.source, out);
+
+    std::int64_t time =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+    out.push_back(static_cast<char>(TagRecord));
+    put_varint(out, zigzag(time - last_time_));
+    out.push_back(static_cast<char>(msg.level));
+    put_varint(out, logger);
+    put_varint(out, source);
+    put_varint(out, msg.thread_id);
+    put_string(out, msg.payload.data(), msg.payload.size());
+    last_time_ = time;
+}
+
+SPDLOG_INLINE void binary_record_encoder::reset() {
+    loggers_.clear();
+    sources_.clear();
+    last_logger_.clear();
+    last_logger_id_ = 0;
+    next_id_ = 1;
+    last_time_ = 0;
+    pending_reset_ = true;
+}
+
+SPDLOG_INLINE std::uint32_t binary_record_encoder::logger_id_(string_view_t name,
+                                                              memory_buf_t &out) {
+    using namespace binary_record_detail;
+
+    if (last_logger_id_ != 0 && last_logger_.size() == name.size() &&
+        std::equal(name.begin(), name.end(), last_logger_.begin())) {
+        return last_logger_id_;
+    }
+
+    last_logger_.assign(name.data(), name.size());
+    auto it = loggers_.find(last_logger_);
+    if (it != loggers_.end()) {
+        last_logger_id_ = it->second;
+        return last_logger_id_;
+    }
+
+    std::uint32_t id = next_id_++;
+    loggers_.emplace(last_logger_, id);
+    out.push_back(static_cast<char>(TagLogger));
+    put_varint(out, id);
+    put_string(out, name.data(), name.size());
+    last_logger_id_ = id;
+    return id;
+}
+
+SPDLOG_INLINE std::uint32_t binary_record_encoder::source_id_(const source_loc &source,
+                                                              memory_buf_t &out) {
+    using namespace binary_record_detail;
+
+    const char *funcname = source.funcname != nullptr ? source.funcname : "";
+    std::size_t filename_size = std::char_traits<char>::length(source.filename);
+    std::size_t funcname_size = std::char_traits<char>::length(funcname);
+
+    /* 键：行号 | 文件名 | '\0' | 函数名 */
+    source_key_.assign(reinterpret_cast<const char *>(&source.line), sizeof(source.line));
+    source_key_.append(source.filename, filename_size);
+    source_key_.push_back('\0');
+    source_key_.append(funcname, funcname_size);
+    auto it = sources_.find(source_key_);
+    if (it != sources_.end()) {
+        return it->second;
+    }
+
+    std::uint32_t id = next_id_++;
+    sources_.emplace(source_key_, id);
+    out.push_back(static_cast<char>(TagSource));
+    put_varint(out, id);
+    put_varint(out, static_cast<std::uint64_t>(source.line));
+    put_string(out, source.filename, filename_size);
+    put_string(out, funcname, funcname_size);
+    return id;
+}
+
+SPDLOG_INLINE bool binary_record_decoder::decode(const char *data,
+                                                 std::size_t size,
+                                                 const record_callback &callback) {
+    using namespace binary_record_detail;
+
+    if (size < MagicSize || !std::equal(Magic, Magic + MagicSize, data)) {
+        return false;
+    }
+
+    loggers_.clear();
+    sources_.clear();
+    std::int64_t last_time = 0;
+    const char *p = data + MagicSize;
+    const char *end = data + size;
+    while (p < end) {
+        auto tag = static_cast<std::uint8_t>(*p++);
+        if (tag == TagReset) {
+            loggers_.clear();
+            sources_.clear();
+            last_time = 0;
+            continue;
+        }
+
+        std::uint64_t id;
+        if (!get_varint(p, end, id)) {
+            break;
+        }
+
+        if (tag == TagLogger) {
+            string_view_t name;
+            if (!get_string(p, end, name)) {
+                break;
+            }
+            loggers_[static_cast<std::uint32_t>(id)].assign(name.data(), name.size());
+        } else if (tag == TagSource) {
+            std::uint64_t line;
+            string_view_t filename, funcname;
+            if (!get_varint(p, end, line) || !get_string(p, end, filename) ||
+                !get_string(p, end, funcname)) {
+                break;
+            }
+            source_entry &entry = sources_[static_cast<std::uint32_t>(id)];
+            entry.filename.assign(filename.data(), filename.size());
+            entry.funcname.assign(funcname.data(), funcname.size());
+            entry.line = static_cast<int>(line);
+        } else if (tag == TagRecord) {
+            /* 记录的第一个字段是时间差，已作为id读出 */
+            if (p >= end) {
+                break;
+            }
+            auto level = static_cast<level::level_enum>(static_cast<unsigned char>(*p++));
+            std::uint64_t logger, source, thread_id;
+            string_view_t payload;
+            if (!get_varint(p, end, logger) || !get_varint(p, end, source) ||
+                !get_varint(p, end, thread_id) || !get_string(p, end, payload)) {
+                break;
+            }
+            last_time += unzigzag(id);
+
+            source_loc loc;
+            auto source_it = sources_.find(static_cast<std::uint32_t>(source));
+            if (source_it != sources_.end()) {
+                loc = source_loc(source_it->second.filename.c_str(), source_it->second.line,
+                                 source_it->second.funcname.c_str());
+            }
+            string_view_t logger_name;
+            auto logger_it = loggers_.find(static_cast<std::uint32_t>(logger));
+            if (logger_it != loggers_.end()) {
+                logger_name = string_view_t(logger_it->second.data(), logger_it->second.size());
+            }
+
+            log_clock::time_point time(std::chrono::duration_cast<log_clock::duration>(
+                std::chrono::nanoseconds(last_time)));
+            log_msg msg(time, loc, logger_name, level, payload);
+            msg.thread_id = static_cast<std::size_t>(thread_id);
+            callback(msg);
+        } else {
+            return false; /* 未知类型，数据损坏 */
+        }
+    }
+    return true;
+}
+
+SPDLOG_INLINE bool binary_record_decoder::is_binary_file(const filename_t &filename) {
+    using namespace binary_record_detail;
+
+    std::FILE *in = std::fopen(filename.c_str(), "rb");
+    if (in == nullptr) {
+        return false;
+    }
+    char header[MagicSize];
+    bool binary = std::fread(header, 1, MagicSize, in) == MagicSize &&
+                  std::equal(Magic, Magic + MagicSize, header);
+    std::fclose(in);
+    return binary;
+}
+
+SPDLOG_INLINE bool binary_record_decoder::render_file(const filename_t &filename,
+                                                      formatter &fmt,
+                                                      std::FILE *out) {
+    mapped_file file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    if (file.size() == 0) {
+        return true;
+    }
+
+    binary_record_decoder decoder;
+    memory_buf_t formatted;
+    return decoder.decode(file.data(), file.size(), [&](const log_msg &msg) {
+        formatted.clear();
+        fmt.format(msg, formatted);
+        std::fwrite(formatted.data(), 1, formatted.size(), out);
+    });
+}
+
+}  // namespace details
+}  // namespace spdlog
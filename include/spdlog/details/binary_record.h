@@ -0,0 +1,84 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/log_msg.h"
+#include "spdlog/formatter.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 二进制日志记录格式：写入时不做pattern格式化，读取时再按pattern渲染
+ *
+ * 文件以8字节魔数 "DTLYBIN1" 开头，之后是若干条记录，首字节为类型：
+ *   1 定义logger名   varint id | varint 长度 | 名字
+ *   2 定义源码位置   varint id | varint 行号 | varint 长度 | 文件名 | varint 长度 | 函数名
+ *   3 日志记录       zigzag varint 时间差(纳秒，相对上一条记录) | u8 级别 | varint logger id |
+ *                    varint 源码位置id(0表示无) | varint 线程id | varint 长度 | 消息内容
+ *   4 重置           清空之前的定义和时间基准（编码端重新开始，如进程重启后追加到已有文件）
+ * 字符串在每个文件中首次出现时定义一次，之后只写id，每个文件可以独立解码
+ */
+class binary_record_encoder {
+public:
+    static void write_header(memory_buf_t &out);
+
+    void encode(const log_msg &msg, memory_buf_t &out);
+
+    /* 开始新文件：清空已定义的字符串和时间基准 */
+    void reset();
+
+private:
+    std::uint32_t logger_id_(string_view_t name, memory_buf_t &out);
+    std::uint32_t source_id_(const source_loc &source, memory_buf_t &out);
+
+    std::unordered_map<std::string, std::uint32_t> loggers_;
+    /* 源码位置按内容区分（文件名、行号、函数名），不依赖指针：
+       同一位置的不同指针共用一个id，复用的缓冲区换了内容也不会得到旧的id */
+    std::unordered_map<std::string, std::uint32_t> sources_;
+    std::string source_key_; /* 查表用的键，复用内存 */
+    std::string last_logger_; /* 上一条记录的logger，连续记录相同时不查表 */
+    std::uint32_t last_logger_id_ = 0;
+    std::uint32_t next_id_ = 1;
+    std::int64_t last_time_ = 0;
+    bool pending_reset_ = true;
+};
+
+/*
+ * 二进制日志的解码：逐条还原为log_msg，可用任意formatter渲染为原来的文本
+ */
+class binary_record_decoder {
+public:
+    using record_callback = std::function<void(const log_msg &msg)>;
+
+    /* 解码完整的文件内容（含魔数），遇到不完整的记录（写入时崩溃）停止；魔数错误时返回false */
+    bool decode(const char *data, std::size_t size, const record_callback &callback);
+
+    /* 文件是否以二进制记录的魔数开头 */
+    static bool is_binary_file(const filename_t &filename);
+
+    /* 解码文件并用formatter渲染，逐行写入out */
+    static bool render_file(const filename_t &filename, formatter &fmt, std::FILE *out);
+
+private:
+    struct source_entry {
+        std::string filename;
+        std::string funcname;
+        int line;
+    };
+
+    std::unordered_map<std::uint32_t, std::string> loggers_;
+    std::unordered_map<std::uint32_t, source_entry> sources_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "binary_record-inl.h"
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/compiled_pattern.h>
+#endif
+
+#include <spdlog/details/os.h>
+#include <spdlog/pattern_formatter.h>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void pattern_cache::update(const compiled_pattern &plan,
+                                         const char *pattern,
+                                         log_clock::time_point time) {
+    auto since_epoch = time.time_since_epoch();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch);
+    if (millis.count() == cached_millis_) {
+        return;
+    }
+    cached_millis_ = millis.count();
+
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    auto fraction = static_cast<int>(
+        (millis - std::chrono::duration_cast<std::chrono::milliseconds>(seconds)).count());
+    millis_[0] = static_cast<char>('0' + fraction / 100);
+    millis_[1] = static_cast<char>('0' + fraction / 10 % 10);
+    millis_[2] = static_cast<char>('0' + fraction % 10);
+
+    if (seconds.count() == cached_second_) {
+        return;
+    }
+    cached_second_ = seconds.count();
+
+    std::tm tm_info = os::localtime(log_clock::to_time_t(time));
+    segments_.clear();
+    for (std::size_t i = 0; i < plan.step_count; ++i) {
+        const pattern_op &step = plan.steps[i];
+        if (step.kind != pattern_op_kind::segment) {
+            continue;
+        }
+        begin_[i] = segments_.size();
+        for (std::size_t k = step.begin; k < step.begin + step.size; ++k) {
+            render_(plan.ops[k], pattern, tm_info, segments_);
+        }
+        end_[i] = segments_.size();
+    }
+}
+
+SPDLOG_INLINE void pattern_cache::render_(const pattern_op &op,
+                                          const char *pattern,
+                                          const std::tm &tm_info,
+                                          memory_buf_t &dest) {
+    switch (op.kind) {
+        case pattern_op_kind::literal:
+            dest.append(pattern + op.begin, pattern + op.begin + op.size);
+            break;
+        case pattern_op_kind::year: fmt_helper::append_int(tm_info.tm_year + 1900, dest); break;
+        case pattern_op_kind::short_year: fmt_helper::pad2(tm_info.tm_year % 100, dest); break;
+        case pattern_op_kind::month: fmt_helper::pad2(tm_info.tm_mon + 1, dest); break;
+        case pattern_op_kind::day: fmt_helper::pad2(tm_info.tm_mday, dest); break;
+        case pattern_op_kind::hour: fmt_helper::pad2(tm_info.tm_hour, dest); break;
+        case pattern_op_kind::minute: fmt_helper::pad2(tm_info.tm_min, dest); break;
+        case pattern_op_kind::second: fmt_helper::pad2(tm_info.tm_sec, dest); break;
+        case pattern_op_kind::date_mdy:
+            fmt_helper::pad2(tm_info.tm_mon + 1, dest);
+            dest.push_back('/');
+            fmt_helper::pad2(tm_info.tm_mday, dest);
+            dest.push_back('/');
+            fmt_helper::pad2(tm_info.tm_year % 100, dest);
+            break;
+        case pattern_op_kind::time_hms:
+            fmt_helper::pad2(tm_info.tm_hour, dest);
+            dest.push_back(':');
+            fmt_helper::pad2(tm_info.tm_min, dest);
+            dest.push_back(':');
+            fmt_helper::pad2(tm_info.tm_sec, dest);
+            break;
+        case pattern_op_kind::eol: fmt_helper::append_string_view(os::default_eol, dest); break;
+        default: break;
+    }
+}
+
+SPDLOG_INLINE compiled_pattern_formatter::compiled_pattern_formatter(std::string pattern)
+    : pattern_(std::move(pattern)),
+      plan_(compile_pattern(pattern_.data(), pattern_.size())) {
+    if (!plan_.supported) {
+        throw_spdlog_ex("compiled_pattern_formatter: unsupported pattern \"" + pattern_ + "\"");
+    }
+}
+
+SPDLOG_INLINE bool compiled_pattern_formatter::supported(const std::string &pattern) {
+    return compile_pattern(pattern.data(), pattern.size()).supported;
+}
+
+SPDLOG_INLINE void compiled_pattern_formatter::format(const log_msg &msg, memory_buf_t &dest) {
+    cache_.update(plan_, pattern_.data(), msg.time);
+    for (std::size_t i = 0; i < plan_.step_count; ++i) {
+        pattern_op_kind kind = plan_.steps[i].kind;
+        if (kind == pattern_op_kind::segment) {
+            cache_.append_segment(i, dest);
+        } else if (kind == pattern_op_kind::millis) {
+            cache_.append_millis(dest);
+        } else {
+            append_pattern_field(kind, msg, dest);
+        }
+    }
+}
+
+SPDLOG_INLINE std::unique_ptr<formatter> compiled_pattern_formatter::clone() const {
+    return std::unique_ptr<formatter>(new compiled_pattern_formatter(pattern_));
+}
+
+SPDLOG_INLINE std::unique_ptr<formatter> make_pattern_formatter(const std::string &pattern) {
+    if (compiled_pattern_formatter::supported(pattern)) {
+        return std::unique_ptr<formatter>(new compiled_pattern_formatter(pattern));
+    }
+    return std::unique_ptr<formatter>(new spdlog::pattern_formatter(pattern));
+}
+
+}  // namespace details
+}  // namespace spdlog
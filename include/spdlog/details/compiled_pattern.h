@@ -0,0 +1,286 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/fmt_helper.h"
+#include "spdlog/details/log_msg.h"
+#include "spdlog/formatter.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+
+/* C++20（类类型非类型模板参数）下pattern可在编译期解析，见static_pattern_formatter */
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    #define SPDLOG_DATELY_STATIC_PATTERN
+    #define SPDLOG_DATELY_PATTERN_CONSTEXPR constexpr
+#else
+    #define SPDLOG_DATELY_PATTERN_CONSTEXPR inline
+#endif
+
+namespace spdlog {
+namespace details {
+
+/* pattern元素；segment之前的种类只依赖于秒级时间（静态），渲染结果按秒缓存 */
+enum class pattern_op_kind : std::uint8_t {
+    literal,     /* pattern中的原样文本（含%%） */
+    year,        /* %Y */
+    short_year,  /* %C */
+    month,       /* %m */
+    day,         /* %d */
+    hour,        /* %H */
+    minute,      /* %M */
+    second,      /* %S */
+    date_mdy,    /* %D */
+    time_hms,    /* %T */
+    eol,         /* 行尾 */
+    segment,     /* 执行步骤：连续的静态元素 */
+    millis,      /* %e，按毫秒缓存 */
+    micros,      /* %f */
+    nanos,       /* %F */
+    level,       /* %l */
+    short_level, /* %L */
+    logger,      /* %n */
+    thread,      /* %t */
+    payload      /* %v */
+};
+
+/* literal为pattern中的[begin, begin + size)，segment为元素下标范围，其余种类不使用 */
+struct pattern_op {
+    pattern_op_kind kind;
+    std::uint16_t begin;
+    std::uint16_t size;
+};
+
+/* 解析结果：元素序列和执行步骤；supported为false时应使用spdlog::pattern_formatter */
+struct compiled_pattern {
+    static constexpr std::size_t MaxOps = 48;
+
+    pattern_op ops[MaxOps];
+    pattern_op steps[MaxOps];
+    std::size_t op_count;
+    std::size_t step_count;
+    bool supported;
+};
+
+SPDLOG_DATELY_PATTERN_CONSTEXPR bool is_static_pattern_op(pattern_op_kind kind) {
+    return kind < pattern_op_kind::segment;
+}
+
+SPDLOG_DATELY_PATTERN_CONSTEXPR void add_pattern_op(compiled_pattern &plan,
+                                                    pattern_op_kind kind,
+                                                    std::size_t begin,
+                                                    std::size_t size) {
+    if (plan.op_count == compiled_pattern::MaxOps) {
+        plan.supported = false;
+        return;
+    }
+    pattern_op &op = plan.ops[plan.op_count++];
+    op.kind = kind;
+    op.begin = static_cast<std::uint16_t>(begin);
+    op.size = static_cast<std::uint16_t>(size);
+}
+
+/*
+ * 解析pattern（C++20下为constexpr）：支持 %Y %C %m %d %H %M %S %D %T %e %f %F %l %L %n %t %v %%，
+ * %^/%$（颜色范围，文件中不输出字符）忽略；带对齐/截断的flag、其他flag或元素过多时supported为false
+ * 时间按本地时间，行尾为默认eol，与同一pattern的spdlog::pattern_formatter输出相同
+ */
+SPDLOG_DATELY_PATTERN_CONSTEXPR compiled_pattern compile_pattern(const char *pattern,
+                                                                 std::size_t size) {
+    compiled_pattern plan{};
+    plan.supported = size <= 0xffff;
+
+    std::size_t i = 0;
+    while (plan.supported && i < size) {
+        if (pattern[i] != '%') {
+            std::size_t begin = i;
+            while (i < size && pattern[i] != '%') {
+                ++i;
+            }
+            add_pattern_op(plan, pattern_op_kind::literal, begin, i - begin);
+            continue;
+        }
+        if (i + 1 == size) {
+            plan.supported = false;
+            break;
+        }
+        switch (pattern[i + 1]) {
+            case '%': add_pattern_op(plan, pattern_op_kind::literal, i + 1, 1); break;
+            case 'Y': add_pattern_op(plan, pattern_op_kind::year, 0, 0); break;
+            case 'C': add_pattern_op(plan, pattern_op_kind::short_year, 0, 0); break;
+            case 'm': add_pattern_op(plan, pattern_op_kind::month, 0, 0); break;
+            case 'd': add_pattern_op(plan, pattern_op_kind::day, 0, 0); break;
+            case 'H': add_pattern_op(plan, pattern_op_kind::hour, 0, 0); break;
+            case 'M': add_pattern_op(plan, pattern_op_kind::minute, 0, 0); break;
+            case 'S': add_pattern_op(plan, pattern_op_kind::second, 0, 0); break;
+            case 'D': add_pattern_op(plan, pattern_op_kind::date_mdy, 0, 0); break;
+            case 'T': add_pattern_op(plan, pattern_op_kind::time_hms, 0, 0); break;
+            case 'e': add_pattern_op(plan, pattern_op_kind::millis, 0, 0); break;
+            case 'f': add_pattern_op(plan, pattern_op_kind::micros, 0, 0); break;
+            case 'F': add_pattern_op(plan, pattern_op_kind::nanos, 0, 0); break;
+            case 'l': add_pattern_op(plan, pattern_op_kind::level, 0, 0); break;
+            case 'L': add_pattern_op(plan, pattern_op_kind::short_level, 0, 0); break;
+            case 'n': add_pattern_op(plan, pattern_op_kind::logger, 0, 0); break;
+            case 't': add_pattern_op(plan, pattern_op_kind::thread, 0, 0); break;
+            case 'v': add_pattern_op(plan, pattern_op_kind::payload, 0, 0); break;
+            case '^':
+            case '$': break;
+            default: plan.supported = false; break;
+        }
+        i += 2;
+    }
+    add_pattern_op(plan, pattern_op_kind::eol, 0, 0);
+    if (!plan.supported) {
+        return plan;
+    }
+
+    /* 连续的静态元素合并为一个segment步骤 */
+    for (std::size_t k = 0; k < plan.op_count; ++k) {
+        pattern_op_kind kind = plan.ops[k].kind;
+        if (!is_static_pattern_op(kind)) {
+            plan.steps[plan.step_count++] = pattern_op{kind, 0, 0};
+        } else if (plan.step_count != 0 &&
+                   plan.steps[plan.step_count - 1].kind == pattern_op_kind::segment) {
+            ++plan.steps[plan.step_count - 1].size;
+        } else {
+            plan.steps[plan.step_count++] =
+                pattern_op{pattern_op_kind::segment, static_cast<std::uint16_t>(k), 1};
+        }
+    }
+    return plan;
+}
+
+/* 输出一个与时间缓存无关的动态元素 */
+inline void append_pattern_field(pattern_op_kind kind, const log_msg &msg, memory_buf_t &dest) {
+    switch (kind) {
+        case pattern_op_kind::micros:
+            fmt_helper::pad6(static_cast<std::size_t>(
+                                 fmt_helper::time_fraction<std::chrono::microseconds>(msg.time)
+                                     .count()),
+                             dest);
+            break;
+        case pattern_op_kind::nanos:
+            fmt_helper::pad9(static_cast<std::size_t>(
+                                 fmt_helper::time_fraction<std::chrono::nanoseconds>(msg.time)
+                                     .count()),
+                             dest);
+            break;
+        case pattern_op_kind::level:
+            fmt_helper::append_string_view(level::to_string_view(msg.level), dest);
+            break;
+        case pattern_op_kind::short_level:
+            fmt_helper::append_string_view(string_view_t(level::to_short_c_str(msg.level)), dest);
+            break;
+        case pattern_op_kind::logger: fmt_helper::append_string_view(msg.logger_name, dest); break;
+        case pattern_op_kind::thread: fmt_helper::append_int(msg.thread_id, dest); break;
+        case pattern_op_kind::payload: fmt_helper::append_string_view(msg.payload, dest); break;
+        default: break;
+    }
+}
+
+/*
+ * 格式化用的时间缓存：秒变化时重新渲染全部segment（日期、时间和其间的原样文本），
+ * 毫秒变化时重新生成%e的三位数字；同一毫秒内的记录只做拷贝
+ */
+class pattern_cache {
+public:
+    void update(const compiled_pattern &plan, const char *pattern, log_clock::time_point time);
+
+    void append_segment(std::size_t step, memory_buf_t &dest) const {
+        dest.append(segments_.data() + begin_[step], segments_.data() + end_[step]);
+    }
+    void append_millis(memory_buf_t &dest) const { dest.append(millis_, millis_ + 3); }
+
+private:
+    static void render_(const pattern_op &op,
+                        const char *pattern,
+                        const std::tm &tm_info,
+                        memory_buf_t &dest);
+
+    std::int64_t cached_second_ = INT64_MIN;
+    std::int64_t cached_millis_ = INT64_MIN;
+    memory_buf_t segments_;
+    std::size_t begin_[compiled_pattern::MaxOps] = {};
+    std::size_t end_[compiled_pattern::MaxOps] = {};
+    char millis_[3] = {'0', '0', '0'};
+};
+
+/* 运行时解析的版本：按执行步骤逐个输出，不经过flag_formatter的虚调用 */
+class compiled_pattern_formatter final : public formatter {
+public:
+    explicit compiled_pattern_formatter(std::string pattern); /* pattern不支持时抛出异常 */
+
+    static bool supported(const std::string &pattern);
+
+    void format(const log_msg &msg, memory_buf_t &dest) override;
+    std::unique_ptr<formatter> clone() const override;
+
+private:
+    std::string pattern_;
+    compiled_pattern plan_;
+    pattern_cache cache_;
+};
+
+/* pattern支持时返回compiled_pattern_formatter，否则返回spdlog::pattern_formatter */
+std::unique_ptr<formatter> make_pattern_formatter(const std::string &pattern);
+
+#ifdef SPDLOG_DATELY_STATIC_PATTERN
+/* 作为模板参数的pattern字符串，如 set_dately_file_pattern<"[%H:%M:%S.%e] %v">() */
+template <std::size_t N>
+struct pattern_string {
+    constexpr pattern_string(const char (&text)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = text[i];
+        }
+    }
+
+    char data[N] = {};
+};
+
+/* 编译期解析的版本：每个执行步骤展开为一段直接的代码（折叠表达式 + if constexpr） */
+template <pattern_string Pattern>
+class static_pattern_formatter final : public formatter {
+public:
+    static constexpr compiled_pattern plan =
+        compile_pattern(Pattern.data, sizeof(Pattern.data) - 1);
+
+    void format(const log_msg &msg, memory_buf_t &dest) override {
+        cache_.update(plan, Pattern.data, msg.time);
+        emit_(msg, dest, std::make_index_sequence<plan.step_count>{});
+    }
+
+    std::unique_ptr<formatter> clone() const override {
+        return std::unique_ptr<formatter>(new static_pattern_formatter());
+    }
+
+private:
+    template <std::size_t... I>
+    void emit_(const log_msg &msg, memory_buf_t &dest, std::index_sequence<I...>) {
+        (emit_step_<I>(msg, dest), ...);
+    }
+
+    template <std::size_t I>
+    void emit_step_(const log_msg &msg, memory_buf_t &dest) {
+        constexpr pattern_op_kind kind = plan.steps[I].kind;
+        if constexpr (kind == pattern_op_kind::segment) {
+            cache_.append_segment(I, dest);
+        } else if constexpr (kind == pattern_op_kind::millis) {
+            cache_.append_millis(dest);
+        } else {
+            append_pattern_field(kind, msg, dest);
+        }
+    }
+
+    pattern_cache cache_;
+};
+#endif
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "compiled_pattern-inl.h"
+#endif
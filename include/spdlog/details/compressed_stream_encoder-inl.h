@@ -0,0 +1,123 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/compressed_stream_encoder.h>
+#endif
+
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE compressed_stream_encoder::compressed_stream_encoder(codec compression,
+                                                                   int level,
+                                                                   std::size_t frame_size)
+    : codec_(compression),
+      frame_size_(frame_size) {
+    std::memset(&zstream_, 0, sizeof(zstream_));
+    if (compression == codec::zstd) {
+#ifdef SPDLOG_DATELY_ZSTD
+        zstd_ = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(zstd_, ZSTD_c_compressionLevel, level);
+#else
+        throw_spdlog_ex("compressed_stream_encoder: zstd support requires SPDLOG_DATELY_ZSTD");
+#endif
+    } else {
+        /* windowBits加16输出gzip格式 */
+        if (deflateInit2(&zstream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw_spdlog_ex("compressed_stream_encoder: deflateInit2 failed");
+        }
+    }
+}
+
+SPDLOG_INLINE compressed_stream_encoder::~compressed_stream_encoder() {
+#ifdef SPDLOG_DATELY_ZSTD
+    if (zstd_ != nullptr) {
+        ZSTD_freeCCtx(zstd_);
+        return;
+    }
+#endif
+    deflateEnd(&zstream_);
+}
+
+SPDLOG_INLINE void compressed_stream_encoder::encode(const char *data,
+                                                     std::size_t size,
+                                                     memory_buf_t &out) {
+#ifdef SPDLOG_DATELY_ZSTD
+    if (zstd_ != nullptr) {
+        char chunk[ChunkSize];
+        ZSTD_inBuffer input = {data, size, 0};
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output = {chunk, sizeof(chunk), 0};
+            std::size_t ret = ZSTD_compressStream2(zstd_, &output, &input, ZSTD_e_continue);
+            if (ZSTD_isError(ret)) {
+                throw_spdlog_ex(std::string("compressed_stream_encoder: ") +
+                                ZSTD_getErrorName(ret));
+            }
+            out.append(chunk, chunk + output.pos);
+        }
+    } else
+#endif
+    {
+        zstream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        zstream_.avail_in = static_cast<uInt>(size);
+        deflate_(Z_NO_FLUSH, out);
+    }
+
+    frame_bytes_ += size;
+    if (frame_bytes_ >= frame_size_) {
+        end_frame(out);
+    }
+}
+
+SPDLOG_INLINE void compressed_stream_encoder::end_frame(memory_buf_t &out) {
+    if (frame_bytes_ == 0) {
+        return;
+    }
+    frame_bytes_ = 0;
+
+#ifdef SPDLOG_DATELY_ZSTD
+    if (zstd_ != nullptr) {
+        char chunk[ChunkSize];
+        ZSTD_inBuffer input = {nullptr, 0, 0};
+        std::size_t remaining;
+        do {
+            ZSTD_outBuffer output = {chunk, sizeof(chunk), 0};
+            remaining = ZSTD_compressStream2(zstd_, &output, &input, ZSTD_e_end);
+            if (ZSTD_isError(remaining)) {
+                throw_spdlog_ex(std::string("compressed_stream_encoder: ") +
+                                ZSTD_getErrorName(remaining));
+            }
+            out.append(chunk, chunk + output.pos);
+        } while (remaining != 0);
+        return;
+    }
+#endif
+
+    /* 结束当前gzip成员，重置后下一帧重新输出gzip头 */
+    zstream_.next_in = nullptr;
+    zstream_.avail_in = 0;
+    deflate_(Z_FINISH, out);
+    deflateReset(&zstream_);
+}
+
+SPDLOG_INLINE const char *compressed_stream_encoder::extension() const {
+    return backup_compressor::extension(codec_);
+}
+
+SPDLOG_INLINE void compressed_stream_encoder::deflate_(int flush, memory_buf_t &out) {
+    char chunk[ChunkSize];
+    int ret;
+    do {
+        zstream_.next_out = reinterpret_cast<Bytef *>(chunk);
+        zstream_.avail_out = sizeof(chunk);
+        ret = deflate(&zstream_, flush);
+        if (ret == Z_STREAM_ERROR) {
+            throw_spdlog_ex("compressed_stream_encoder: deflate failed");
+        }
+        out.append(chunk, chunk + (sizeof(chunk) - zstream_.avail_out));
+    } while (zstream_.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+}
+
+}  // namespace details
+}  // namespace spdlog
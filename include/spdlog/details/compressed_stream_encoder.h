@@ -0,0 +1,66 @@
+#pragma once
+
+#include "spdlog/details/backup_compressor.h"
+#include "spdlog/details/stream_encoder.h"
+#include <cstddef>
+
+/*
+ * 依赖zlib（gzip）；定义SPDLOG_DATELY_ZSTD后支持zstd（需要链接libzstd）
+ */
+
+#ifdef SPDLOG_DATELY_ZSTD
+    #include <zstd.h>
+#endif
+#include <zlib.h>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 流式压缩：每积累frame_size字节（未压缩）或调用end_frame()时结束一帧
+ * zstd每帧是一个完整的zstd帧，gzip每帧是一个完整的gzip成员，
+ * 文件可以直接用zstdcat/zcat读取，也可以在任意帧边界之后继续追加
+ */
+class compressed_stream_encoder final : public stream_encoder {
+public:
+    using codec = backup_compressor::codec;
+
+    /* 默认编解码器：构建了zstd支持时为zstd，否则为gzip，保证无参构造在任何构建中可用 */
+#ifdef SPDLOG_DATELY_ZSTD
+    static constexpr codec DefaultCodec = codec::zstd;
+#else
+    static constexpr codec DefaultCodec = codec::gzip;
+#endif
+
+    explicit compressed_stream_encoder(codec compression = DefaultCodec,
+                                       int level = 3,
+                                       std::size_t frame_size = 64 * 1024);
+    ~compressed_stream_encoder() override;
+
+    compressed_stream_encoder(const compressed_stream_encoder &) = delete;
+    compressed_stream_encoder &operator=(const compressed_stream_encoder &) = delete;
+
+    void encode(const char *data, std::size_t size, memory_buf_t &out) override;
+    void end_frame(memory_buf_t &out) override;
+    const char *extension() const override;
+
+private:
+    static constexpr std::size_t ChunkSize = 16 * 1024;
+
+    void deflate_(int flush, memory_buf_t &out);
+
+    codec codec_;
+    std::size_t frame_size_;
+    std::size_t frame_bytes_ = 0; /* 当前帧已输入的未压缩字节数 */
+    z_stream zstream_;
+#ifdef SPDLOG_DATELY_ZSTD
+    ZSTD_CCtx *zstd_ = nullptr;
+#endif
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "compressed_stream_encoder-inl.h"
+#endif
@@ -0,0 +1,354 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/dately_log_reader.h>
+#endif
+
+#include <spdlog/details/time_index.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+namespace log_reader_detail {
+
+inline bool read_digits(const char *p, std::size_t count, int &value) {
+    value = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (p[i] < '0' || p[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (p[i] - '0');
+    }
+    return true;
+}
+
+}  // namespace log_reader_detail
+
+SPDLOG_INLINE dately_log_reader::dately_log_reader(filename_t base_filename,
+                                                  time_parser parser,
+                                                  filename_t backup_prefix)
+    : base_filename_(std::move(base_filename)),
+      naming_(std::move(backup_prefix)),
+      parser_(std::move(parser)) {
+    size_t pos = base_filename_.find_last_of("/\\");
+    if (pos == filename_t::npos) {
+        base_filename_only_ = base_filename_;
+    } else {
+        directory_ = base_filename_.substr(0, pos);
+        base_filename_only_ = base_filename_.substr(pos + 1);
+    }
+    pos = base_filename_only_.rfind(".log");
+    if (pos != filename_t::npos) {
+        backup_suffix_ = base_filename_only_.substr(pos + 4);
+    }
+    reset_files_(discover_backups_());
+    open_file_(0);
+}
+
+SPDLOG_INLINE void dately_log_reader::seek(log_clock::time_point from) {
+    reset_files_(discover_backups_());
+    rotation_seen_ = false;
+
+    /* 定位期间不跟随新写入的数据 */
+    bool follow = follow_;
+    follow_ = false;
+
+    /*
+     * 备份中的记录都不晚于文件名中的轮转时间（精确到秒），轮转时间早于from所在秒的备份可以整个跳过；
+     * 二分查找第一个不满足的文件，不需要打开之前的文件
+     */
+    std::time_t from_seconds = log_clock::to_time_t(from);
+    if (log_clock::from_time_t(from_seconds) > from) {
+        --from_seconds; /* to_time_t可能向上取整 */
+    }
+    auto first = std::lower_bound(rotated_at_.begin(), rotated_at_.end(), from_seconds);
+    std::size_t start = static_cast<std::size_t>(first - rotated_at_.begin());
+    open_file_(start);
+
+    /* 用时间索引跳到from之前最近的条目；索引过期（偏移不在记录边界上）时从头读 */
+    std::vector<time_index_entry> entries;
+    if (time_index::read(time_index::sidecar_filename(files_[start]), entries)) {
+        std::int64_t from_time = time_index::to_index_time(from);
+        auto it = std::partition_point(
+            entries.begin(), entries.end(),
+            [&](const time_index_entry &entry) { return entry.time <= from_time; });
+        if (it != entries.begin()) {
+            std::size_t offset = static_cast<std::size_t>((it - 1)->offset);
+            if (offset <= map_.size() && (offset == 0 || map_.data()[offset - 1] == '\n')) {
+                pos_ = offset;
+            }
+        }
+    }
+
+    /* 跳过更早的记录，停在第一条不早于from的记录之前 */
+    log_record record;
+    while (next(record)) {
+        if (record.time >= from) {
+            pos_ = static_cast<std::size_t>(record.text.data() - map_.data());
+            break;
+        }
+    }
+    follow_ = follow;
+}
+
+SPDLOG_INLINE bool dately_log_reader::next(log_record &record) {
+    for (;;) {
+        if (pos_ < map_.size()) {
+            const char *begin = map_.data() + pos_;
+            const char *end = map_.data() + map_.size();
+            auto newline = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+            if (newline != nullptr) {
+                emit_(record, begin, newline);
+                pos_ = static_cast<std::size_t>(newline - map_.data()) + 1;
+                return true;
+            }
+            /* 备份不会再增长，末尾没有换行的记录也返回 */
+            if (!is_live_()) {
+                emit_(record, begin, end);
+                pos_ = map_.size();
+                return true;
+            }
+        }
+
+        if (!is_live_()) {
+            open_file_(file_index_ + 1);
+            continue;
+        }
+        if (!follow_ || !poll_live_()) {
+            return false;
+        }
+    }
+}
+
+SPDLOG_INLINE void dately_log_reader::set_follow(bool follow) { follow_ = follow; }
+
+/* 目录中的明文备份，按文件名中的时间和轮转序号排序 */
+SPDLOG_INLINE std::vector<backup_file> dately_log_reader::discover_backups_() const {
+    std::vector<backup_file> found;
+    auto add_file = [&](const filename_t &name) {
+        backup_stamp stamp;
+        std::size_t suffix_pos;
+        if (name != base_filename_only_ && naming_.parse(name, stamp, suffix_pos) &&
+            name.compare(suffix_pos, filename_t::npos, backup_suffix_) == 0) {
+            found.push_back({name, stamp.time, 0, stamp.sequence});
+        }
+    };
+#ifdef _WIN32
+    WIN32_FIND_DATAA find_data;
+    filename_t pattern = (directory_.empty() ? filename_t(".") : directory_) + "\\" +
+                         naming_.prefix() + "*.log" + backup_suffix_;
+    HANDLE hFind = FindFirstFileA(pattern.c_str(), &find_data);
+    if (hFind != INVALID_HANDLE_VALUE) {
+        do {
+            if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                add_file(find_data.cFileName);
+            }
+        } while (FindNextFileA(hFind, &find_data) != 0);
+        FindClose(hFind);
+    }
+#else
+    DIR *dir = opendir(directory_.empty() ? "." : directory_.c_str());
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            add_file(entry->d_name);
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::sort(found.begin(), found.end(), backup_older);
+    if (!directory_.empty()) {
+        for (auto &file : found) {
+            file.filename = directory_ + "/" + file.filename;
+        }
+    }
+    return found;
+}
+
+SPDLOG_INLINE void dately_log_reader::reset_files_(std::vector<backup_file> backups) {
+    files_.clear();
+    rotated_at_.clear();
+    files_.reserve(backups.size() + 1);
+    rotated_at_.reserve(backups.size());
+    for (auto &file : backups) {
+        files_.push_back(std::move(file.filename));
+        rotated_at_.push_back(file.time);
+    }
+    files_.push_back(base_filename_);
+    file_index_ = 0;
+    map_.close();
+    pos_ = 0;
+}
+
+/* 打开第index个文件；打不开（如已被清理）时保持关闭状态，读取时会跳过 */
+SPDLOG_INLINE bool dately_log_reader::open_file_(std::size_t index) {
+    file_index_ = index;
+    pos_ = 0;
+    if (index >= files_.size()) {
+        map_.close();
+        return false;
+    }
+    return map_.open(files_[index]);
+}
+
+SPDLOG_INLINE bool dately_log_reader::is_live_() const {
+    return file_index_ + 1 >= files_.size();
+}
+
+/* 跟随模式下检查当前文件：有新数据时返回true；被轮转时切换到之后产生的备份和新的当前文件 */
+SPDLOG_INLINE bool dately_log_reader::poll_live_() {
+    if (map_.is_open()) {
+        if (map_.remap()) {
+            /* 文件被截断时从头读 */
+            if (pos_ > map_.size()) {
+                pos_ = 0;
+            }
+            rotation_seen_ = false;
+            return true;
+        }
+        if (map_.same_file(base_filename_)) {
+            return false;
+        }
+        /* 写入方可能在改名之后才关闭旧文件（写出缓冲区），多等一次再切换 */
+        if (!rotation_seen_) {
+            rotation_seen_ = true;
+            return false;
+        }
+    }
+    rotation_seen_ = false;
+
+    /* 找到旧文件改名后的备份，从它之后的备份继续 */
+    std::vector<backup_file> backups = discover_backups_();
+    std::size_t start = backups.size();
+    if (map_.is_open()) {
+        for (std::size_t i = backups.size(); i-- > 0;) {
+            if (map_.same_file(backups[i].filename)) {
+                start = i + 1;
+                break;
+            }
+        }
+    }
+    backups.erase(backups.begin(), backups.begin() + static_cast<std::ptrdiff_t>(start));
+    reset_files_(std::move(backups));
+    open_file_(0);
+    return map_.is_open() || files_.size() > 1;
+}
+
+SPDLOG_INLINE void dately_log_reader::emit_(log_record &record, const char *begin, const char *end) {
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+    record.text = string_view_t(begin, static_cast<std::size_t>(end - begin));
+    if (!parse_time_(record.text, record.time)) {
+        record.time = last_time_;
+    }
+    last_time_ = record.time;
+}
+
+SPDLOG_INLINE bool dately_log_reader::parse_time_(string_view_t line, log_clock::time_point &time) {
+    if (parser_) {
+        return parser_(line, time);
+    }
+    return parse_default_time_(line, time);
+}
+
+/* 解析 "[YYYY-mm-dd HH:MM:SS.eee]" 前缀，固定位置读数字 */
+SPDLOG_INLINE bool dately_log_reader::parse_default_time_(string_view_t line,
+                                                          log_clock::time_point &time) {
+    using log_reader_detail::read_digits;
+
+    const char *p = line.data();
+    if (line.size() < 25 || p[0] != '[' || p[5] != '-' || p[8] != '-' || p[11] != ' ' ||
+        p[14] != ':' || p[17] != ':' || p[20] != '.' || p[24] != ']') {
+        return false;
+    }
+
+    int minute, second, millis;
+    if (!read_digits(p + 15, 2, minute) || !read_digits(p + 18, 2, second) ||
+        !read_digits(p + 21, 3, millis)) {
+        return false;
+    }
+
+    if (std::memcmp(cached_hour_, p + 1, sizeof(cached_hour_)) != 0) {
+        int year, month, day, hour;
+        if (!read_digits(p + 1, 4, year) || !read_digits(p + 6, 2, month) ||
+            !read_digits(p + 9, 2, day) || !read_digits(p + 12, 2, hour)) {
+            return false;
+        }
+        std::tm tm_info = {};
+        tm_info.tm_year = year - 1900;
+        tm_info.tm_mon = month - 1;
+        tm_info.tm_mday = day;
+        tm_info.tm_hour = hour;
+        tm_info.tm_isdst = -1;
+        cached_hour_time_ = std::mktime(&tm_info);
+        std::memcpy(cached_hour_, p + 1, sizeof(cached_hour_));
+    }
+
+    time = log_clock::from_time_t(cached_hour_time_) +
+           std::chrono::duration_cast<log_clock::duration>(
+               std::chrono::seconds(minute * 60 + second) + std::chrono::milliseconds(millis));
+    return true;
+}
+
+SPDLOG_INLINE void merged_log_reader::add(std::unique_ptr<dately_log_reader> reader) {
+    source s;
+    s.reader = std::move(reader);
+    s.has_head = false;
+    sources_.push_back(std::move(s));
+}
+
+SPDLOG_INLINE void merged_log_reader::add_shards(const filename_t &base_filename,
+                                                 std::size_t shards,
+                                                 const filename_t &backup_prefix) {
+    for (std::size_t i = 0; i < shards; ++i) {
+        add(std::unique_ptr<dately_log_reader>(new dately_log_reader(
+            base_filename + "." + std::to_string(i), dately_log_reader::time_parser(),
+            backup_prefix)));
+    }
+}
+
+SPDLOG_INLINE void merged_log_reader::seek(log_clock::time_point from) {
+    for (auto &s : sources_) {
+        s.reader->seek(from);
+        s.has_head = false;
+    }
+    last_ = static_cast<std::size_t>(-1);
+}
+
+SPDLOG_INLINE bool merged_log_reader::next(log_record &record) {
+    /* 上次返回的记录此时才推进其来源，保证返回的内容在下一次调用前有效 */
+    std::size_t best = static_cast<std::size_t>(-1);
+    for (std::size_t i = 0; i < sources_.size(); ++i) {
+        source &s = sources_[i];
+        if (i == last_ || !s.has_head) {
+            s.has_head = s.reader->next(s.head);
+        }
+        if (s.has_head && (best == static_cast<std::size_t>(-1) ||
+                           s.head.time < sources_[best].head.time)) {
+            best = i;
+        }
+    }
+
+    last_ = best;
+    if (best == static_cast<std::size_t>(-1)) {
+        return false;
+    }
+    record = sources_[best].head;
+    return true;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/backup_catalog.h"
+#include "spdlog/details/backup_name.h"
+#include "spdlog/details/mapped_file.h"
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/* 一条日志记录：时间和内容（不含换行符，直接指向映射内存，下一次调用next()前有效） */
+struct log_record {
+    log_clock::time_point time;
+    string_view_t text;
+};
+
+/*
+ * rotating_dately_file_sink输出的读取端：按时间顺序遍历目录中的明文备份（默认前缀时为"app_*.log"，
+ * 文件名格式见details::backup_name）和当前文件，文件用mmap映射，记录不做拷贝
+ * 当前文件名在".log"之后还有后缀时（如分片文件"app.log.3"），只读取后缀相同的备份（"app_*.log.3"）
+ *
+ * 记录按换行分隔，时间默认从spdlog默认格式的前缀 "[YYYY-mm-dd HH:MM:SS.eee]" 解析（本地时间），
+ * 其他格式可传入自定义解析函数；无法解析时间的行（如多行消息的后续行）沿用上一条记录的时间
+ * 压缩备份（.gz/.zst）和流式编码输出无法直接映射，不在读取范围内
+ *
+ * 跟随模式（set_follow(true)）：读到当前文件末尾后next()返回false，之后再次调用会读取新写入的记录；
+ * 当前文件被rotate_()改名后先读完旧文件，再依次读取期间产生的备份和新的当前文件
+ */
+class dately_log_reader {
+public:
+    using time_parser = std::function<bool(string_view_t line, log_clock::time_point &time)>;
+
+    explicit dately_log_reader(filename_t base_filename,
+                               time_parser parser = time_parser(),
+                               filename_t backup_prefix = SPDLOG_FILENAME_T("app_"));
+
+    dately_log_reader(const dately_log_reader &) = delete;
+    dately_log_reader &operator=(const dately_log_reader &) = delete;
+
+    /*
+     * 定位到第一条时间不早于from的记录：备份文件名中的时间是轮转时间（文件中最晚的记录不晚于它），
+     * 按它二分查找起始文件；有时间索引（"<文件>.idx"）时直接跳到附近的偏移
+     */
+    void seek(log_clock::time_point from);
+
+    /* 读取下一条记录，没有更多记录时返回false；只有以换行结束的记录才会返回 */
+    bool next(log_record &record);
+
+    void set_follow(bool follow);
+
+private:
+    std::vector<backup_file> discover_backups_() const;
+    void reset_files_(std::vector<backup_file> backups);
+    bool open_file_(std::size_t index);
+    bool is_live_() const;
+    bool poll_live_();
+    void emit_(log_record &record, const char *begin, const char *end);
+    bool parse_time_(string_view_t line, log_clock::time_point &time);
+    bool parse_default_time_(string_view_t line, log_clock::time_point &time);
+
+    filename_t base_filename_;
+    filename_t base_filename_only_;
+    filename_t directory_;
+    filename_t backup_suffix_; /* 备份文件名中".log"之后的部分，与当前文件名相同 */
+    backup_name naming_;
+    time_parser parser_;
+    std::vector<filename_t> files_; /* 按时间排列的待读文件，最后一个是当前文件 */
+    std::vector<std::time_t> rotated_at_; /* files_中各备份文件名中的轮转时间（不含当前文件） */
+    std::size_t file_index_ = 0;
+    mapped_file map_;
+    std::size_t pos_ = 0;
+    bool follow_ = false;
+    bool rotation_seen_ = false; /* 已发现当前文件被改名，等待一次确认旧文件写完 */
+    log_clock::time_point last_time_;
+    /* 默认解析的缓存："YYYY-mm-dd HH"前缀及其对应的整点时间，每小时只调用一次mktime */
+    char cached_hour_[13] = {};
+    std::time_t cached_hour_time_ = 0;
+};
+
+/*
+ * 多个读取端的时间顺序合并（如多个sink或多个进程的日志），每次返回各来源中时间最早的记录
+ * 每次线性比较各来源的首条记录（几十个分片时比较开销仍远小于读取）；
+ * 跟随模式下暂时没有记录的来源在每次调用时重新尝试
+ */
+class merged_log_reader {
+public:
+    void add(std::unique_ptr<dately_log_reader> reader);
+    /* 添加sharded_dately_file_sink的全部分片（"<base>.0" ~ "<base>.<shards-1>"） */
+    void add_shards(const filename_t &base_filename,
+                    std::size_t shards,
+                    const filename_t &backup_prefix = SPDLOG_FILENAME_T("app_"));
+    void seek(log_clock::time_point from);
+    bool next(log_record &record);
+
+private:
+    struct source {
+        std::unique_ptr<dately_log_reader> reader;
+        log_record head;
+        bool has_head;
+    };
+
+    std::vector<source> sources_;
+    std::size_t last_ = static_cast<std::size_t>(-1); /* 上次返回记录的来源，下次调用时再推进 */
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "dately_log_reader-inl.h"
+#endif
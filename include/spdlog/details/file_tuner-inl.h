@@ -0,0 +1,111 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/file_tuner.h>
+#endif
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+/* 打开失败时不抛出异常，只是不做优化 */
+SPDLOG_INLINE file_tuner::file_tuner(const filename_t &filename,
+                                     std::size_t preallocate_size,
+                                     std::size_t evict_window)
+    : evict_window_(evict_window) {
+#ifdef __linux__
+    fd_ = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_ >= 0 && preallocate_size != 0) {
+        /* 文件系统不支持时（如EOPNOTSUPP）忽略 */
+        (void)::fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(preallocate_size));
+    }
+#else
+    (void)filename;
+    (void)preallocate_size;
+#endif
+}
+
+SPDLOG_INLINE file_tuner::~file_tuner() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+SPDLOG_INLINE bool file_tuner::supported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+SPDLOG_INLINE void file_tuner::written(std::size_t bytes) {
+    if (evict_window_ == 0) {
+        return;
+    }
+    pending_ += bytes;
+    if (pending_ < evict_window_) {
+        return;
+    }
+    pending_ = 0;
+#ifdef __linux__
+    struct stat st;
+    if (fd_ < 0 || ::fstat(fd_, &st) != 0) {
+        return;
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    if (size < writeback_end_ + evict_window_) {
+        return;
+    }
+    if (writeback_end_ > evicted_end_) {
+        auto offset = static_cast<off64_t>(evicted_end_);
+        auto length = static_cast<off64_t>(writeback_end_ - evicted_end_);
+        ::sync_file_range(fd_, offset, length,
+                          SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                              SYNC_FILE_RANGE_WAIT_AFTER);
+        ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length),
+                        POSIX_FADV_DONTNEED);
+        evicted_end_ = writeback_end_;
+    }
+    ::sync_file_range(fd_, static_cast<off64_t>(writeback_end_),
+                      static_cast<off64_t>(size - writeback_end_), SYNC_FILE_RANGE_WRITE);
+    writeback_end_ = size;
+#endif
+}
+
+SPDLOG_INLINE void file_tuner::release_space() {
+#ifdef __linux__
+    struct stat st;
+    if (fd_ >= 0 && ::fstat(fd_, &st) == 0) {
+        /* 截断到当前大小即释放文件末尾之后的预分配块 */
+        (void)::ftruncate(fd_, st.st_size);
+    }
+#endif
+}
+
+SPDLOG_INLINE void file_tuner::evict_all() {
+    if (evict_window_ == 0) {
+        return;
+    }
+#ifdef __linux__
+    if (fd_ < 0) {
+        return;
+    }
+    /* 长度为0表示到文件末尾 */
+    ::sync_file_range(fd_, 0, 0,
+                      SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                          SYNC_FILE_RANGE_WAIT_AFTER);
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    evicted_end_ = writeback_end_;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 活动日志文件的空间预分配和页缓存管理（仅Linux，其他平台上各操作为空）
+ * 使用独立的文件描述符，与file_helper打开同一个文件；轮转后由维护任务对旧文件收尾
+ *
+ * 预分配用FALLOC_FL_KEEP_SIZE，不改变文件大小，追加写入不受影响；
+ * 页缓存按窗口逐步移除：每写满一个窗口启动该窗口的异步回写，并等待上一个窗口回写完成后
+ * 用posix_fadvise(DONTNEED)移除（上一个窗口已回写了一个窗口的时间，通常不需要等待）
+ */
+class file_tuner {
+public:
+    /* preallocate_size为0不预分配，evict_window为0不移除页缓存 */
+    file_tuner(const filename_t &filename, std::size_t preallocate_size, std::size_t evict_window);
+    ~file_tuner();
+
+    file_tuner(const file_tuner &) = delete;
+    file_tuner &operator=(const file_tuner &) = delete;
+
+    static bool supported();
+
+    /* 又有bytes字节交给了文件句柄（日志线程调用）；每累计一个窗口用fstat取文件的实际大小，
+       回写和移除只针对已经进入内核的数据，还在stdio缓冲区或异步写入队列中的部分留到下次 */
+    void written(std::size_t bytes);
+    void release_space();           /* 截断到实际大小，释放未用完的预分配空间 */
+    void evict_all();               /* 等待整个文件回写后从页缓存移除 */
+
+private:
+    std::size_t evict_window_;
+    std::size_t pending_ = 0;       /* 上次检查文件大小之后交给文件句柄的字节数 */
+    std::size_t writeback_end_ = 0; /* 已启动回写的范围终点 */
+    std::size_t evicted_end_ = 0;   /* 已移除的范围终点 */
+#ifdef __linux__
+    int fd_ = -1;
+#endif
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "file_tuner-inl.h"
+#endif
@@ -0,0 +1,187 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/flight_recorder.h>
+#endif
+
+#include <spdlog/details/mapped_file.h>
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+namespace flight_recorder_detail {
+
+static const char Magic[8] = {'D', 'T', 'L', 'Y', 'R', 'N', 'G', '1'};
+static const std::size_t HeaderSize = 64;
+static const std::size_t CapacityOffset = 8;
+static const std::size_t WritePosOffset = 16;
+
+inline std::uint64_t load_u64(const char *p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline void store_u64(char *p, std::uint64_t value) { std::memcpy(p, &value, sizeof(value)); }
+
+}  // namespace flight_recorder_detail
+
+SPDLOG_INLINE flight_recorder::flight_recorder(const filename_t &filename, std::size_t capacity)
+    : filename_(filename),
+      capacity_(capacity),
+      write_pos_(0) {
+    using namespace flight_recorder_detail;
+    if (capacity == 0) {
+        throw_spdlog_ex("flight_recorder: capacity cannot be zero");
+    }
+    std::size_t file_size = HeaderSize + capacity;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw_spdlog_ex("flight_recorder: failed opening " + os::filename_to_str(filename),
+                        static_cast<int>(GetLastError()));
+    }
+    file_ = file;
+    auto size64 = static_cast<unsigned long long>(file_size);
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE,
+                                        static_cast<DWORD>(size64 >> 32),
+                                        static_cast<DWORD>(size64), NULL);
+    void *view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, file_size) : NULL;
+    if (view == NULL) {
+        int error = static_cast<int>(GetLastError());
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw_spdlog_ex("flight_recorder: failed mapping " + os::filename_to_str(filename), error);
+    }
+    mapping_ = mapping;
+#else
+    fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw_spdlog_ex("flight_recorder: failed opening " + os::filename_to_str(filename), errno);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || static_cast<std::size_t>(st.st_size) != file_size) {
+        /* 大小不同时重建（ftruncate补零，写入映射页时不会因文件过短而SIGBUS） */
+        if (::ftruncate(fd_, static_cast<off_t>(file_size)) != 0) {
+            int error = errno;
+            ::close(fd_);
+            throw_spdlog_ex("flight_recorder: failed resizing " + os::filename_to_str(filename),
+                            error);
+        }
+    }
+    void *view = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (view == MAP_FAILED) {
+        int error = errno;
+        ::close(fd_);
+        throw_spdlog_ex("flight_recorder: failed mapping " + os::filename_to_str(filename), error);
+    }
+#endif
+    header_ = static_cast<char *>(view);
+    data_ = header_ + HeaderSize;
+
+    /* 容量相同的有效文件接着写，否则重新初始化 */
+    if (std::memcmp(header_, Magic, sizeof(Magic)) == 0 &&
+        load_u64(header_ + CapacityOffset) == capacity) {
+        write_pos_ = load_u64(header_ + WritePosOffset);
+    } else {
+        std::memset(header_, 0, HeaderSize);
+        store_u64(header_ + CapacityOffset, capacity);
+        store_u64(header_ + WritePosOffset, 0);
+        std::memcpy(header_, Magic, sizeof(Magic));
+    }
+}
+
+SPDLOG_INLINE flight_recorder::~flight_recorder() {
+    std::size_t file_size = flight_recorder_detail::HeaderSize + capacity_;
+#ifdef _WIN32
+    UnmapViewOfFile(header_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    CloseHandle(static_cast<HANDLE>(file_));
+    (void)file_size;
+#else
+    munmap(header_, file_size);
+    ::close(fd_);
+#endif
+}
+
+SPDLOG_INLINE void flight_recorder::write(const char *data, std::size_t size) {
+    if (size > capacity_) {
+        write_pos_ += size - capacity_;
+        data += size - capacity_;
+        size = capacity_;
+    }
+    auto offset = static_cast<std::size_t>(write_pos_ % capacity_);
+    std::size_t first = std::min(size, capacity_ - offset);
+    std::memcpy(data_ + offset, data, first);
+    std::memcpy(data_, data + first, size - first);
+    write_pos_ += size;
+
+    /* 数据先于位置写入，崩溃时文件头中的位置之前的数据都是完整的 */
+    std::atomic_signal_fence(std::memory_order_release);
+    flight_recorder_detail::store_u64(header_ + flight_recorder_detail::WritePosOffset,
+                                      write_pos_);
+}
+
+SPDLOG_INLINE const filename_t &flight_recorder::filename() const { return filename_; }
+
+SPDLOG_INLINE std::size_t flight_recorder::capacity() const { return capacity_; }
+
+SPDLOG_INLINE bool flight_recorder::recover(const filename_t &filename, std::FILE *out) {
+    using namespace flight_recorder_detail;
+    mapped_file file;
+    if (!file.open(filename) || file.size() < HeaderSize ||
+        std::memcmp(file.data(), Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+    std::uint64_t capacity = load_u64(file.data() + CapacityOffset);
+    std::uint64_t write_pos = load_u64(file.data() + WritePosOffset);
+    if (capacity == 0 || file.size() != HeaderSize + capacity) {
+        return false;
+    }
+    const char *data = file.data() + HeaderSize;
+
+    if (write_pos <= capacity) {
+        std::fwrite(data, 1, static_cast<std::size_t>(write_pos), out);
+        return true;
+    }
+
+    /* 已回绕：最旧的数据从write_pos处开始，跳过被覆盖了开头的那一行 */
+    auto start = static_cast<std::size_t>(write_pos % capacity);
+    auto cap = static_cast<std::size_t>(capacity);
+    const char *older = data + start;
+    std::size_t older_size = cap - start;
+    const char *newline = static_cast<const char *>(std::memchr(older, '\n', older_size));
+    if (newline != nullptr) {
+        std::size_t skip = static_cast<std::size_t>(newline - older) + 1;
+        std::fwrite(older + skip, 1, older_size - skip, out);
+        std::fwrite(data, 1, start, out);
+    } else {
+        newline = static_cast<const char *>(std::memchr(data, '\n', start));
+        std::size_t skip = newline != nullptr ? static_cast<std::size_t>(newline - data) + 1 : 0;
+        std::fwrite(data + skip, 1, start - skip, out);
+    }
+    return true;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 飞行记录器：内存映射的环形文件，每条记录只做内存拷贝，不经过系统调用
+ * 映射为共享映射，进程崩溃（包括SIGKILL）后已写入的页仍由内核写回文件，
+ * 之后用recover()取出最后的记录；掉电或内核崩溃时未回写的页仍会丢失
+ *
+ * 文件格式：64字节文件头（魔数"DTLYRNG1"、容量、累计写入字节数，本机字节序）+ 容量大小的数据区
+ * 打开容量相同的已有文件时接着上次的位置继续写，上一次运行的尾部在被覆盖前仍可恢复
+ */
+class flight_recorder {
+public:
+    flight_recorder(const filename_t &filename, std::size_t capacity);
+    ~flight_recorder();
+
+    flight_recorder(const flight_recorder &) = delete;
+    flight_recorder &operator=(const flight_recorder &) = delete;
+
+    /* 追加一条记录（调用方负责互斥），超过容量的记录只保留末尾部分 */
+    void write(const char *data, std::size_t size);
+    const filename_t &filename() const;
+    std::size_t capacity() const;
+
+    /* 按写入顺序输出环形文件中的内容，环形已回绕时从第一条完整的行开始；文件无效时返回false */
+    static bool recover(const filename_t &filename, std::FILE *out);
+
+private:
+    filename_t filename_;
+    std::size_t capacity_;
+    std::uint64_t write_pos_; /* 累计写入字节数，写完数据后再存入文件头 */
+    char *header_ = nullptr;
+    char *data_ = nullptr;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "flight_recorder-inl.h"
+#endif
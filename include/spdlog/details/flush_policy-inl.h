@@ -0,0 +1,129 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/flush_policy.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE sync_file::sync_file(const filename_t &filename)
+    : filename_(filename) {
+#ifdef _WIN32
+    /* FlushFileBuffers需要写权限 */
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw_spdlog_ex("sync_file: failed opening " + os::filename_to_str(filename),
+                        static_cast<int>(GetLastError()));
+    }
+    file_ = file;
+#else
+    fd_ = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_ < 0) {
+        throw_spdlog_ex("sync_file: failed opening " + os::filename_to_str(filename), errno);
+    }
+#endif
+}
+
+SPDLOG_INLINE sync_file::~sync_file() {
+#ifdef _WIN32
+    CloseHandle(file_);
+#else
+    ::close(fd_);
+#endif
+}
+
+SPDLOG_INLINE void sync_file::sync() {
+#ifdef _WIN32
+    bool ok = FlushFileBuffers(file_) != 0;
+#elif defined(__APPLE__)
+    bool ok = ::fsync(fd_) == 0;
+#else
+    bool ok = ::fdatasync(fd_) == 0;
+#endif
+    if (!ok) {
+        throw_spdlog_ex("sync_file: failed syncing " + os::filename_to_str(filename_), errno);
+    }
+}
+
+SPDLOG_INLINE const filename_t &sync_file::filename() const { return filename_; }
+
+SPDLOG_INLINE void group_commit::set_file(std::shared_ptr<sync_file> file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ && synced_ < written_) {
+        retired_.push_back(std::move(file_));
+    }
+    file_ = std::move(file);
+}
+
+SPDLOG_INLINE std::uint64_t group_commit::mark() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ++written_;
+}
+
+SPDLOG_INLINE void group_commit::wait(std::uint64_t seq) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (synced_ < seq) {
+        if (syncing_) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        /* 成为本轮的同步者：覆盖开始同步前已mark()的全部写入 */
+        syncing_ = true;
+        std::uint64_t target = written_;
+        std::vector<std::shared_ptr<sync_file>> files;
+        files.swap(retired_);
+        files.push_back(file_);
+        lock.unlock();
+
+        bool ok = true;
+        std::string error;
+        std::vector<std::shared_ptr<sync_file>> failed; /* 同步失败的旧文件 */
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            if (!files[i]) {
+                continue;
+            }
+            try {
+                files[i]->sync();
+            } catch (const spdlog_ex &ex) {
+                ok = false;
+                error = ex.what();
+                if (i + 1 < files.size()) {
+                    failed.push_back(std::move(files[i]));
+                }
+            }
+        }
+
+        lock.lock();
+        syncing_ = false;
+        if (ok) {
+            synced_ = std::max(synced_, target);
+        } else {
+            /* 只有失败的旧文件留待下次重试，当前文件每次都会同步 */
+            retired_.insert(retired_.end(), failed.begin(), failed.end());
+        }
+        cv_.notify_all();
+        if (!ok) {
+            throw_spdlog_ex(error);
+        }
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * rotating_dately_file_sink的flush策略：写入时检查，满足任一条件即flush
+ * durable为true时flush之后还要fdatasync落盘，轮转时旧文件在改名前落盘
+ */
+struct flush_policy {
+    std::size_t every_bytes;          /* 自上次flush写出的字节数，0表示不按字节 */
+    std::chrono::milliseconds every;  /* 距上次flush的时间（按记录时间），0表示不按时间 */
+    bool durable;
+};
+
+/* 仅用于落盘的文件句柄：与file_helper打开同一个文件，fdatasync作用于文件本身而非句柄 */
+class sync_file {
+public:
+    explicit sync_file(const filename_t &filename);
+    ~sync_file();
+
+    sync_file(const sync_file &) = delete;
+    sync_file &operator=(const sync_file &) = delete;
+
+    void sync(); /* 失败时抛出异常 */
+    const filename_t &filename() const;
+
+private:
+    filename_t filename_;
+#ifdef _WIN32
+    void *file_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+/*
+ * 组提交：调用方把数据交给内核后用mark()取得序号，再用wait()等待该序号之前的写入落盘；
+ * 同时等待的调用方共享一次fdatasync（由第一个发现无人同步的调用方执行，不持有任何sink锁）
+ * 轮转后用set_file()切换到新文件，旧文件若还有未落盘的写入，下一次同步时一并处理
+ */
+class group_commit {
+public:
+    void set_file(std::shared_ptr<sync_file> file);
+    std::uint64_t mark();
+    void wait(std::uint64_t seq);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::shared_ptr<sync_file> file_;
+    std::vector<std::shared_ptr<sync_file>> retired_; /* 已轮转但尚未落盘的旧文件 */
+    std::uint64_t written_ = 0;                       /* 最近一次mark()的序号 */
+    std::uint64_t synced_ = 0;                        /* 已落盘的最大序号 */
+    bool syncing_ = false;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "flush_policy-inl.h"
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/log_suppressor.h>
+#endif
+
+#include <spdlog/details/fmt_helper.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+namespace log_suppressor_detail {
+
+inline std::uint64_t mix(std::uint64_t h, std::uint64_t k) {
+    h ^= k * 0x9e3779b97f4a7c15ULL;
+    h = (h << 31) | (h >> 33);
+    return h * 0xbf58476d1ce4e5b9ULL;
+}
+
+/* 每次处理8字节；末尾混入长度，空串也要混入（否则logger名与消息的分界不影响结果） */
+inline std::uint64_t hash_bytes(std::uint64_t h, const char *data, std::size_t size) {
+    /* 空的string_view的data可能为空指针，不能传给memcpy */
+    if (size == 0) {
+        return mix(h, 0);
+    }
+    while (size >= 8) {
+        std::uint64_t k;
+        std::memcpy(&k, data, 8);
+        h = mix(h, k);
+        data += 8;
+        size -= 8;
+    }
+    std::uint64_t tail = 0;
+    if (size != 0) {
+        std::memcpy(&tail, data, size);
+    }
+    return mix(h, tail ^ (static_cast<std::uint64_t>(size) << 56));
+}
+
+}  // namespace log_suppressor_detail
+
+SPDLOG_INLINE log_suppressor::log_suppressor(const suppression_policy &policy, std::size_t slots)
+    : mask_(0) {
+    if (policy.burst == 0 || policy.interval.count() <= 0) {
+        throw_spdlog_ex("log_suppressor: burst and interval must be positive");
+    }
+    /* 槽数取不小于slots的2的幂 */
+    std::size_t size = MaxProbes;
+    while (size < slots) {
+        size <<= 1;
+    }
+    table_.assign(size, entry());
+    mask_ = size - 1;
+    interval_ = std::chrono::duration_cast<std::chrono::nanoseconds>(policy.interval).count();
+    emission_ = std::max<std::int64_t>(interval_ / static_cast<std::int64_t>(policy.burst), 1);
+    tolerance_ = emission_ * static_cast<std::int64_t>(policy.burst - 1);
+}
+
+SPDLOG_INLINE std::uint64_t log_suppressor::hash_(const log_msg &msg) {
+    using namespace log_suppressor_detail;
+    std::uint64_t h = mix(reinterpret_cast<std::uintptr_t>(msg.source.filename),
+                          static_cast<std::uint64_t>(msg.source.line) << 8 |
+                              static_cast<std::uint64_t>(msg.level));
+    h = hash_bytes(h, msg.logger_name.data(), msg.logger_name.size());
+    h = hash_bytes(h, msg.payload.data(), msg.payload.size());
+    return h == 0 ? 1 : h;
+}
+
+SPDLOG_INLINE bool log_suppressor::admit(const log_msg &msg, suppression_summary &pending) {
+    pending.count = 0;
+    std::uint64_t key = hash_(msg);
+    std::int64_t now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+
+    /* 在探测范围内找同一个键，找不到时取空槽或理论到达时间最早（最久不活跃）的槽 */
+    entry *slot = nullptr;
+    entry *victim = nullptr;
+    for (std::size_t i = 0; i < MaxProbes; ++i) {
+        entry &e = table_[(key + i) & mask_];
+        if (e.key == key) {
+            slot = &e;
+            break;
+        }
+        if (victim == nullptr || (victim->key != 0 && (e.key == 0 || e.tat < victim->tat))) {
+            victim = &e;
+        }
+    }
+
+    if (slot == nullptr) {
+        if (victim->suppressed != 0) {
+            pending.count = victim->suppressed;
+            pending.level = victim->level;
+            pending.source = victim->source;
+            pending.current_key = false;
+        }
+        victim->key = key;
+        victim->tat = now + emission_;
+        victim->suppressed = 0;
+        victim->summary_time = now;
+        victim->source = msg.source;
+        victim->level = msg.level;
+        return true;
+    }
+
+    if (slot->tat - tolerance_ > now) {
+        ++slot->suppressed;
+        return false;
+    }
+    slot->tat = std::max(slot->tat, now) + emission_;
+    /* 汇总每interval最多写出一次，持续被抑制的键每个间隔一条汇总 */
+    if (slot->suppressed != 0 && now - slot->summary_time >= interval_) {
+        pending.count = slot->suppressed;
+        pending.level = slot->level;
+        pending.source = slot->source;
+        pending.current_key = true;
+        slot->suppressed = 0;
+        slot->summary_time = now;
+    }
+    return true;
+}
+
+SPDLOG_INLINE void log_suppressor::collect_idle(log_clock::time_point now,
+                                                std::vector<suppression_summary> &out,
+                                                bool force) {
+    std::int64_t t =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    if (!force && t < next_sweep_) {
+        return;
+    }
+    next_sweep_ = t + interval_;
+    for (auto &e : table_) {
+        if (e.suppressed != 0 && (force || e.tat <= t)) {
+            suppression_summary summary;
+            summary.count = e.suppressed;
+            summary.level = e.level;
+            summary.source = e.source;
+            summary.current_key = false;
+            out.push_back(summary);
+            e.suppressed = 0;
+            e.summary_time = t;
+        }
+    }
+}
+
+SPDLOG_INLINE void log_suppressor::format_summary(const suppression_summary &summary,
+                                                  memory_buf_t &dest) {
+    fmt_helper::append_string_view("suppressed ", dest);
+    fmt_helper::append_int(summary.count, dest);
+    fmt_helper::append_string_view(" similar messages", dest);
+    if (!summary.source.empty()) {
+        fmt_helper::append_string_view(" from ", dest);
+        fmt_helper::append_string_view(summary.source.filename, dest);
+        dest.push_back(':');
+        fmt_helper::append_int(summary.source.line, dest);
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
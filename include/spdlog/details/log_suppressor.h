@@ -0,0 +1,75 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/log_msg.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/* 重复抑制策略：同一调用点、logger、级别和消息内容的记录每interval最多写出burst条 */
+struct suppression_policy {
+    std::size_t burst;               /* 0表示关闭 */
+    std::chrono::milliseconds interval;
+};
+
+/* 被抑制记录的汇总（写出为 "suppressed N similar messages"） */
+struct suppression_summary {
+    std::uint64_t count; /* 0表示没有需要写出的汇总 */
+    level::level_enum level;
+    source_loc source;
+    bool current_key; /* 与当前记录是同一个键（汇总可沿用其logger名） */
+};
+
+/*
+ * 重复抑制：定长的开放寻址哈希表（每个槽一个缓存行以内，最多探测4个槽），键为调用点、logger、
+ * 级别和消息内容的哈希，每个键一个令牌桶（GCRA，只存一个理论到达时间）
+ * 被抑制的记录只计数，汇总每个键每interval最多一条：在该键放行的记录之前、条目被替换时
+ * 或该键空闲后写出
+ * 不加锁，由调用方（sink锁内）串行调用；时间取记录时间
+ */
+class log_suppressor {
+public:
+    explicit log_suppressor(const suppression_policy &policy, std::size_t slots = 1024);
+
+    /* 返回false表示抑制该记录；pending.count非0时应先写出汇总（条目被替换时也可能在抑制时给出） */
+    bool admit(const log_msg &msg, suppression_summary &pending);
+
+    /* 取出已空闲（令牌桶已回满）且有未汇总计数的键；每interval最多扫描一次，force时总是扫描 */
+    void collect_idle(log_clock::time_point now,
+                      std::vector<suppression_summary> &out,
+                      bool force = false);
+
+    static void format_summary(const suppression_summary &summary, memory_buf_t &dest);
+
+private:
+    static constexpr std::size_t MaxProbes = 4;
+
+    struct entry {
+        std::uint64_t key; /* 0表示空槽 */
+        std::int64_t tat;  /* 理论到达时间（纳秒），早于它的记录消耗突发额度 */
+        std::uint64_t suppressed;
+        std::int64_t summary_time; /* 上次写出汇总（或插入）的时间 */
+        source_loc source;
+        level::level_enum level;
+    };
+
+    static std::uint64_t hash_(const log_msg &msg);
+
+    std::vector<entry> table_;
+    std::size_t mask_;
+    std::int64_t emission_;  /* 每条记录占用的时间（interval / burst） */
+    std::int64_t tolerance_; /* 突发容忍量（(burst - 1) * emission_） */
+    std::int64_t interval_;
+    std::int64_t next_sweep_ = 0;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "log_suppressor-inl.h"
+#endif
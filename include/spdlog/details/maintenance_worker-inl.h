@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/maintenance_worker.h>
+#endif
+
+#include <cstdio>
+#include <exception>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE maintenance_worker::maintenance_worker(std::size_t max_tasks)
+    : tasks_(max_tasks) {
+    if (max_tasks == 0) {
+        throw_spdlog_ex("maintenance_worker: max_tasks arg cannot be zero");
+    }
+    thread_ = std::thread(&maintenance_worker::worker_loop_, this);
+}
+
+SPDLOG_INLINE maintenance_worker::~maintenance_worker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    push_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+SPDLOG_INLINE void maintenance_worker::post(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pop_cv_.wait(lock, [this] { return !tasks_.full(); });
+        tasks_.push_back(std::move(task));
+        ++pending_;
+    }
+    push_cv_.notify_one();
+}
+
+SPDLOG_INLINE void maintenance_worker::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+SPDLOG_INLINE void maintenance_worker::worker_loop_() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            push_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            /* 退出前先把剩余任务执行完，保证备份文件都被关闭和登记 */
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        pop_cv_.notify_one();
+
+        /* 维护任务失败不能终止线程，只输出错误信息 */
+        try {
+            task();
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "[*** LOG ERROR ***] maintenance_worker: %s\n", ex.what());
+        } catch (...) {
+            std::fprintf(stderr, "[*** LOG ERROR ***] maintenance_worker: unknown exception\n");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/circular_q.h"
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 后台维护线程：执行文件关闭、备份登记、过期文件删除等耗时的文件系统操作，
+ * 使日志线程只负责切换到新文件
+ * 任务队列有界，队列满时post()阻塞，可由多个sink共享
+ */
+class maintenance_worker {
+public:
+    explicit maintenance_worker(std::size_t max_tasks = 128);
+    ~maintenance_worker(); /* 执行完队列中剩余的任务后退出 */
+
+    maintenance_worker(const maintenance_worker &) = delete;
+    maintenance_worker &operator=(const maintenance_worker &) = delete;
+
+    void post(std::function<void()> task);
+    void wait_idle(); /* 阻塞直到已提交的任务全部执行完毕（用于测试和关闭） */
+
+private:
+    void worker_loop_();
+
+    std::mutex mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+    std::condition_variable idle_cv_;
+    circular_q<std::function<void()>> tasks_;
+    std::size_t pending_ = 0; /* 已提交但未执行完的任务数 */
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "maintenance_worker-inl.h"
+#endif
@@ -0,0 +1,178 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/mapped_file.h>
+#endif
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE mapped_file::~mapped_file() { close(); }
+
+SPDLOG_INLINE bool mapped_file::open(const filename_t &filename) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_ = file;
+#else
+    fd_ = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+#endif
+    filename_ = filename;
+    if (!map_(file_size_())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+SPDLOG_INLINE void mapped_file::close() {
+    unmap_();
+#ifdef _WIN32
+    if (file_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(file_));
+        file_ = nullptr;
+    }
+#else
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+    filename_.clear();
+}
+
+SPDLOG_INLINE bool mapped_file::is_open() const {
+#ifdef _WIN32
+    return file_ != nullptr;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+SPDLOG_INLINE bool mapped_file::remap() {
+    if (!is_open()) {
+        return false;
+    }
+    std::size_t size = file_size_();
+    if (size == size_) {
+        return false;
+    }
+    unmap_();
+    return map_(size);
+}
+
+SPDLOG_INLINE bool mapped_file::same_file(const filename_t &path) const {
+    if (!is_open()) {
+        return false;
+    }
+#ifdef _WIN32
+    HANDLE other = CreateFileA(path.c_str(), 0,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (other == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION a, b;
+    bool same = GetFileInformationByHandle(static_cast<HANDLE>(file_), &a) &&
+                GetFileInformationByHandle(other, &b) &&
+                a.dwVolumeSerialNumber == b.dwVolumeSerialNumber &&
+                a.nFileIndexHigh == b.nFileIndexHigh && a.nFileIndexLow == b.nFileIndexLow;
+    CloseHandle(other);
+    return same;
+#else
+    struct stat a, b;
+    if (fstat(fd_, &a) != 0 || stat(path.c_str(), &b) != 0) {
+        return false;
+    }
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+#endif
+}
+
+SPDLOG_INLINE const char *mapped_file::data() const { return data_; }
+
+SPDLOG_INLINE std::size_t mapped_file::size() const { return size_; }
+
+SPDLOG_INLINE const filename_t &mapped_file::filename() const { return filename_; }
+
+/* 空文件不映射，data()为nullptr */
+SPDLOG_INLINE bool mapped_file::map_(std::size_t size) {
+    size_ = 0;
+    if (size == 0) {
+        return true;
+    }
+#ifdef _WIN32
+    HANDLE mapping =
+        CreateFileMappingA(static_cast<HANDLE>(file_), NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<const char *>(view);
+#else
+    void *view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    /* 顺序读取 */
+    madvise(view, size, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(view);
+#endif
+    size_ = size;
+    return true;
+}
+
+SPDLOG_INLINE void mapped_file::unmap_() {
+    if (data_ == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    munmap(const_cast<char *>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+SPDLOG_INLINE std::size_t mapped_file::file_size_() const {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(static_cast<HANDLE>(file_), &size)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(size.QuadPart);
+#else
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(st.st_size);
+#endif
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 只读内存映射文件
+ * 文件在映射期间被重命名（轮转）不影响读取；文件增长后调用remap()映射新增部分
+ */
+class mapped_file {
+public:
+    mapped_file() = default;
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    bool open(const filename_t &filename);
+    void close();
+    bool is_open() const;
+
+    /* 按文件当前大小重新映射，大小有变化时返回true（映射地址可能改变） */
+    bool remap();
+
+    /* 打开的文件与path是否为同一个文件（path被轮转替换后返回false） */
+    bool same_file(const filename_t &path) const;
+
+    const char *data() const;
+    std::size_t size() const;
+    const filename_t &filename() const;
+
+private:
+    bool map_(std::size_t size);
+    void unmap_();
+    std::size_t file_size_() const;
+
+    filename_t filename_;
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "mapped_file-inl.h"
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/mpsc_record_ring.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE mpsc_record_ring::mpsc_record_ring(std::size_t capacity) {
+    std::size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_.reset(new slot[size]);
+    for (std::size_t i = 0; i < size; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+SPDLOG_INLINE bool mpsc_record_ring::try_push(log_clock::time_point time,
+                                              const memory_buf_t &record) {
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    slot *s;
+    for (;;) {
+        s = &slots_[pos & mask_];
+        std::size_t seq = s->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; /* 队列已满 */
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    s->time = time;
+    s->record.append(record.data(), record.data() + record.size());
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+SPDLOG_INLINE std::size_t mpsc_record_ring::pushed() const {
+    return enqueue_pos_.load(std::memory_order_acquire);
+}
+
+SPDLOG_INLINE std::size_t mpsc_record_ring::consumed() const {
+    return consumed_.load(std::memory_order_acquire);
+}
+
+}  // namespace details
+}  // namespace spdlog
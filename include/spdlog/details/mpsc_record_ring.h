@@ -0,0 +1,64 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 无锁多生产者/单消费者环形队列，保存已格式化的日志记录
+ * 每个槽位带序号（Vyukov有界队列），生产者用CAS预留槽位，
+ * 槽位中的缓冲区重复使用，稳定后不再分配内存
+ */
+class mpsc_record_ring {
+public:
+    explicit mpsc_record_ring(std::size_t capacity); /* 容量向上取整为2的幂 */
+
+    mpsc_record_ring(const mpsc_record_ring &) = delete;
+    mpsc_record_ring &operator=(const mpsc_record_ring &) = delete;
+
+    /* 写入一条记录，队列满时返回false */
+    bool try_push(log_clock::time_point time, const memory_buf_t &record);
+
+    /* 取出一条记录并在槽位上原地调用consume(time, record)，队列空时返回false */
+    template <typename Consumer>
+    bool try_consume(Consumer &&consume) {
+        slot &s = slots_[dequeue_pos_ & mask_];
+        std::size_t seq = s.sequence.load(std::memory_order_acquire);
+        if (seq != dequeue_pos_ + 1) {
+            return false;
+        }
+        consume(s.time, static_cast<const memory_buf_t &>(s.record));
+        s.record.clear();
+        s.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_pos_;
+        consumed_.store(dequeue_pos_, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t pushed() const;   /* 已预留的记录数（单调递增） */
+    std::size_t consumed() const; /* 已取出的记录数（单调递增） */
+
+private:
+    struct slot {
+        std::atomic<std::size_t> sequence{0};
+        log_clock::time_point time;
+        memory_buf_t record;
+    };
+
+    std::size_t mask_;
+    std::unique_ptr<slot[]> slots_;
+    std::atomic<std::size_t> enqueue_pos_{0};
+    std::size_t dequeue_pos_ = 0; /* 只由消费者访问 */
+    std::atomic<std::size_t> consumed_{0};
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "mpsc_record_ring-inl.h"
+#endif
@@ -0,0 +1,146 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/rotation_schedule.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+
+namespace spdlog {
+namespace details {
+
+namespace rotation_schedule_detail {
+
+static const std::int64_t SecondsPerDay = 24 * 3600;
+
+inline std::int64_t floor_div(std::int64_t a, std::int64_t b) {
+    return a / b - (a % b < 0 ? 1 : 0);
+}
+
+inline std::int64_t make_time(tm fields, int isdst) {
+    fields.tm_isdst = isdst;
+    return static_cast<std::int64_t>(std::mktime(&fields));
+}
+
+}  // namespace rotation_schedule_detail
+
+SPDLOG_INLINE rotation_schedule::rotation_schedule()
+    : rotation_schedule(rotation_schedule_detail::SecondsPerDay, 0, false) {}
+
+SPDLOG_INLINE rotation_schedule::rotation_schedule(std::int64_t step,
+                                                   std::int64_t offset,
+                                                   bool utc)
+    : step_(step),
+      offset_(offset),
+      utc_(utc) {}
+
+SPDLOG_INLINE rotation_schedule rotation_schedule::every_minutes(int minutes, bool utc) {
+    if (minutes < 1 || minutes > 24 * 60) {
+        throw_spdlog_ex("rotation_schedule: minutes must be between 1 and 1440");
+    }
+    return rotation_schedule(static_cast<std::int64_t>(minutes) * 60, 0, utc);
+}
+
+SPDLOG_INLINE rotation_schedule rotation_schedule::hourly(bool utc) {
+    return every_minutes(60, utc);
+}
+
+SPDLOG_INLINE rotation_schedule rotation_schedule::daily(int hour, int minute, bool utc) {
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        throw_spdlog_ex("rotation_schedule: invalid time of day");
+    }
+    return rotation_schedule(rotation_schedule_detail::SecondsPerDay,
+                             static_cast<std::int64_t>(hour) * 3600 + minute * 60, utc);
+}
+
+SPDLOG_INLINE log_clock::time_point rotation_schedule::next_boundary(log_clock::time_point time) {
+    std::int64_t t =
+        std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    if (t < day_start_ || t >= day_end_) {
+        load_day_(t);
+    }
+
+    /* 当天没有更晚的边界时取下一天的第一个（每天至少有一个边界，最多再看两天） */
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        if (irregular_.empty()) {
+            std::int64_t first = day_start_ + offset_;
+            std::int64_t boundary = t < first ? first : first + ((t - first) / step_ + 1) * step_;
+            if (boundary < day_end_) {
+                return log_clock::from_time_t(static_cast<std::time_t>(boundary));
+            }
+        } else {
+            auto it = std::upper_bound(irregular_.begin(), irregular_.end(), t);
+            if (it != irregular_.end()) {
+                return log_clock::from_time_t(static_cast<std::time_t>(*it));
+            }
+        }
+        load_day_(day_end_);
+    }
+    return log_clock::from_time_t(static_cast<std::time_t>(day_start_));
+}
+
+SPDLOG_INLINE void rotation_schedule::load_day_(std::int64_t t) {
+    using namespace rotation_schedule_detail;
+    irregular_.clear();
+    if (utc_) {
+        day_start_ = floor_div(t, SecondsPerDay) * SecondsPerDay;
+        day_end_ = day_start_ + SecondsPerDay;
+        return;
+    }
+
+    tm midnight = os::localtime(static_cast<std::time_t>(t));
+    midnight.tm_hour = 0;
+    midnight.tm_min = 0;
+    midnight.tm_sec = 0;
+    tm next_midnight = midnight;
+    ++next_midnight.tm_mday;
+    day_start_ = make_time(midnight, -1);
+    day_end_ = make_time(next_midnight, -1);
+
+    /* 0点不存在或重复时t可能落在算出的范围之外，扩展范围使其包含t */
+    day_start_ = std::min(day_start_, t);
+    day_end_ = std::max(day_end_, t + 1);
+    if (day_end_ - day_start_ != SecondsPerDay) {
+        load_irregular_day_(midnight);
+    }
+}
+
+/* 夏令时切换的一天：按墙上时间逐个求边界，标准时间和夏令时两种解释中能还原出同一墙上时间的都是边界 */
+SPDLOG_INLINE void rotation_schedule::load_irregular_day_(const tm &midnight) {
+    using namespace rotation_schedule_detail;
+    for (std::int64_t wall = offset_; wall < SecondsPerDay; wall += step_) {
+        tm fields = midnight;
+        fields.tm_hour = static_cast<int>(wall / 3600);
+        fields.tm_min = static_cast<int>(wall / 60 % 60);
+        bool found = false;
+        for (int isdst = 0; isdst <= 1; ++isdst) {
+            std::int64_t boundary = make_time(fields, isdst);
+            tm check = os::localtime(static_cast<std::time_t>(boundary));
+            if (check.tm_mday == fields.tm_mday && check.tm_hour == fields.tm_hour &&
+                check.tm_min == fields.tm_min && boundary >= day_start_ && boundary < day_end_) {
+                irregular_.push_back(boundary);
+                found = true;
+            }
+        }
+        if (!found) {
+            /* 被跳过的墙上时间，mktime顺延到跳变之后 */
+            std::int64_t boundary = make_time(fields, -1);
+            if (boundary >= day_start_ && boundary < day_end_) {
+                irregular_.push_back(boundary);
+            }
+        }
+    }
+    std::sort(irregular_.begin(), irregular_.end());
+    irregular_.erase(std::unique(irregular_.begin(), irregular_.end()), irregular_.end());
+    if (step_ >= SecondsPerDay && irregular_.size() > 1) {
+        irregular_.resize(1);
+    }
+    if (irregular_.empty()) {
+        irregular_.push_back(day_start_);
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
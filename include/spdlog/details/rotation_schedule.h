@@ -0,0 +1,50 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 按日历对齐的轮转周期：每N分钟、每小时或每天HH:MM，按UTC或本地时间
+ * 分钟周期从每天0点起算（不能整除一天时当天最后一个周期较短）；本地时间按墙上时间对齐，
+ * 缓存当天的范围，普通的日子只在换天时调用两次mktime（当天和次日0点），边界按固定步长推算；
+ * 夏令时切换当天逐个计算边界：跳过的时刻顺延，重复的时刻两次都是分钟周期的边界（每天的周期取第一次）
+ * 不加锁，由调用方（sink锁内）串行调用
+ */
+class rotation_schedule {
+public:
+    rotation_schedule(); /* 每天本地时间0点 */
+
+    static rotation_schedule every_minutes(int minutes, bool utc = false); /* 1 ~ 1440 */
+    static rotation_schedule hourly(bool utc = false);
+    static rotation_schedule daily(int hour = 0, int minute = 0, bool utc = false);
+
+    /* time之后（不含time）的第一个边界 */
+    log_clock::time_point next_boundary(log_clock::time_point time);
+
+private:
+    rotation_schedule(std::int64_t step, std::int64_t offset, bool utc);
+
+    void load_day_(std::int64_t t); /* 缓存包含t（秒）的一天 */
+    void load_irregular_day_(const tm &midnight);
+
+    std::int64_t step_;   /* 周期（秒），每天一次时为一天 */
+    std::int64_t offset_; /* 每天第一个边界的墙上时间（距0点的秒数） */
+    bool utc_;
+
+    /* 缓存的一天[day_start_, day_end_)；irregular_为空时边界为day_start_ + offset_ + k * step_ */
+    std::int64_t day_start_ = 0;
+    std::int64_t day_end_ = 0;
+    std::vector<std::int64_t> irregular_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "rotation_schedule-inl.h"
+#endif
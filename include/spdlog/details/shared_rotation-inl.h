@@ -0,0 +1,295 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/shared_rotation.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/file.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/* robust锁：持有者退出后下一个加锁者得到EOWNERDEAD，而不是永久阻塞 */
+#ifdef __linux__
+    #define SPDLOG_DATELY_ROBUST_MUTEX
+#endif
+
+namespace spdlog {
+namespace details {
+
+#ifdef _WIN32
+struct shared_rotation_block {};
+
+SPDLOG_INLINE shared_rotation::shared_rotation(const filename_t &control_filename)
+    : filename_(control_filename) {
+    throw_spdlog_ex("shared_rotation: multi-process mode is not supported on Windows");
+}
+
+SPDLOG_INLINE shared_rotation::~shared_rotation() {}
+SPDLOG_INLINE bool shared_rotation::lock() { return false; }
+SPDLOG_INLINE void shared_rotation::unlock() {}
+SPDLOG_INLINE std::uint64_t shared_rotation::generation() const { return 0; }
+SPDLOG_INLINE std::uint64_t shared_rotation::size() const { return 0; }
+SPDLOG_INLINE void shared_rotation::open_file(const filename_t &) {}
+SPDLOG_INLINE void shared_rotation::write(const char *, std::size_t) {}
+SPDLOG_INLINE log_clock::time_point shared_rotation::rotation_time() const { return {}; }
+SPDLOG_INLINE void shared_rotation::attach(std::uint64_t, std::uint64_t, log_clock::time_point) {}
+SPDLOG_INLINE std::uint64_t shared_rotation::next_sequence() { return 0; }
+SPDLOG_INLINE void shared_rotation::record_backup(const backup_file &) {}
+SPDLOG_INLINE bool shared_rotation::read_backups(std::uint64_t,
+                                                 std::uint64_t,
+                                                 std::vector<backup_file> &) const {
+    return false;
+}
+SPDLOG_INLINE void shared_rotation::rotated(log_clock::time_point) {}
+SPDLOG_INLINE void shared_rotation::reset(std::uint64_t) {}
+#else
+
+/* 一次轮转产生的备份，按序号存放在环形的记录中 */
+struct shared_backup_record {
+    std::uint64_t sequence; /* 0表示空 */
+    std::int64_t time;
+    std::uint64_t size;
+    char name[104]; /* 不含目录，以'\0'结尾 */
+};
+
+/* 控制文件的内容，字段在初始化时原地构造；魔数最后写入，表示初始化完成 */
+struct shared_rotation_block {
+    static constexpr std::size_t HistorySize = 64;
+
+    char magic[8];
+    std::uint32_t block_size; /* sizeof(shared_rotation_block)，不同构建之间不共用 */
+    pthread_mutex_t mutex;
+    std::atomic<std::uint64_t> size;
+    std::atomic<std::uint64_t> generation;
+    std::atomic<std::int64_t> rotation_time; /* log_clock的计数 */
+    std::uint64_t sequence;                  /* 以下持锁访问 */
+    shared_backup_record history[HistorySize];
+};
+
+namespace shared_rotation_detail {
+
+static const char Magic[8] = {'D', 'T', 'L', 'Y', 'C', 'T', 'L', '1'};
+
+inline bool initialized(const shared_rotation_block *block) {
+    return std::memcmp(block->magic, Magic, sizeof(Magic)) == 0;
+}
+
+inline void initialize(shared_rotation_block *block) {
+    std::memset(static_cast<void *>(block), 0, sizeof(shared_rotation_block));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    #ifdef SPDLOG_DATELY_ROBUST_MUTEX
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    #endif
+    pthread_mutex_init(&block->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    new (&block->size) std::atomic<std::uint64_t>(0);
+    new (&block->generation) std::atomic<std::uint64_t>(1);
+    new (&block->rotation_time) std::atomic<std::int64_t>(0);
+    block->sequence = 0;
+    block->block_size = sizeof(shared_rotation_block);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(block->magic, Magic, sizeof(Magic));
+}
+
+}  // namespace shared_rotation_detail
+
+SPDLOG_INLINE shared_rotation::shared_rotation(const filename_t &control_filename)
+    : filename_(control_filename) {
+    using namespace shared_rotation_detail;
+    int fd = ::open(control_filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw_spdlog_ex("shared_rotation: failed opening " + os::filename_to_str(control_filename),
+                        errno);
+    }
+
+    /* 文件锁保证只有一个进程初始化控制块，其他进程等待初始化完成后再映射 */
+    if (::flock(fd, LOCK_EX) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw_spdlog_ex("shared_rotation: failed locking " + os::filename_to_str(control_filename),
+                        error);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw_spdlog_ex("shared_rotation: failed stat " + os::filename_to_str(control_filename),
+                        error);
+    }
+    /* 大小不同的控制文件来自不兼容的构建，可能仍有进程在使用，不能重新初始化 */
+    if (st.st_size != 0 && static_cast<std::size_t>(st.st_size) != sizeof(shared_rotation_block)) {
+        ::close(fd);
+        throw_spdlog_ex("shared_rotation: " + os::filename_to_str(control_filename) +
+                        " has an incompatible layout");
+    }
+    if (st.st_size == 0 && ::ftruncate(fd, sizeof(shared_rotation_block)) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw_spdlog_ex(
+            "shared_rotation: failed resizing " + os::filename_to_str(control_filename), error);
+    }
+    void *view =
+        mmap(nullptr, sizeof(shared_rotation_block), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        int error = errno;
+        ::close(fd);
+        throw_spdlog_ex(
+            "shared_rotation: failed mapping " + os::filename_to_str(control_filename), error);
+    }
+    block_ = static_cast<shared_rotation_block *>(view);
+
+    /* 没有魔数：新建的文件，或初始化的进程在写入魔数前退出（持有文件锁，不会有其他进程在用） */
+    if (!initialized(block_)) {
+        initialize(block_);
+    } else if (block_->block_size != sizeof(shared_rotation_block)) {
+        munmap(view, sizeof(shared_rotation_block));
+        block_ = nullptr;
+        ::close(fd);
+        throw_spdlog_ex("shared_rotation: " + os::filename_to_str(control_filename) +
+                        " has an incompatible layout");
+    }
+
+    /* 映射建立后不再需要文件描述符（关闭时释放文件锁） */
+    ::close(fd);
+}
+
+SPDLOG_INLINE shared_rotation::~shared_rotation() {
+    munmap(block_, sizeof(shared_rotation_block));
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+SPDLOG_INLINE bool shared_rotation::lock() {
+    int rc = pthread_mutex_lock(&block_->mutex);
+    #ifdef SPDLOG_DATELY_ROBUST_MUTEX
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(&block_->mutex);
+        return true;
+    }
+    #endif
+    if (rc != 0) {
+        throw_spdlog_ex("shared_rotation: failed locking " + os::filename_to_str(filename_), rc);
+    }
+    return false;
+}
+
+SPDLOG_INLINE void shared_rotation::unlock() { pthread_mutex_unlock(&block_->mutex); }
+
+SPDLOG_INLINE std::uint64_t shared_rotation::generation() const {
+    return block_->generation.load(std::memory_order_acquire);
+}
+
+SPDLOG_INLINE std::uint64_t shared_rotation::size() const {
+    return block_->size.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void shared_rotation::open_file(const filename_t &filename) {
+    int fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw_spdlog_ex("shared_rotation: failed opening " + os::filename_to_str(filename), errno);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+}
+
+/* 普通文件上的O_APPEND写入整体追加到文件末尾，不会与其他进程的写入交错 */
+SPDLOG_INLINE void shared_rotation::write(const char *data, std::size_t size) {
+    std::size_t total = size;
+    while (size != 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_spdlog_ex("shared_rotation: failed writing to log file", errno);
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    block_->size.fetch_add(total, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE log_clock::time_point shared_rotation::rotation_time() const {
+    return log_clock::time_point(
+        log_clock::duration(block_->rotation_time.load(std::memory_order_relaxed)));
+}
+
+SPDLOG_INLINE void shared_rotation::attach(std::uint64_t file_size,
+                                           std::uint64_t sequence,
+                                           log_clock::time_point rotation_time) {
+    /* 其他进程的write()不持锁累加大小，这里只补上计数落后于实际大小的差值（新建的控制块，
+       或写入后尚未累加），不覆盖并发的累加 */
+    std::uint64_t current = block_->size.load(std::memory_order_relaxed);
+    while (current < file_size &&
+           !block_->size.compare_exchange_weak(current, file_size, std::memory_order_relaxed)) {
+    }
+    block_->sequence = std::max(block_->sequence, sequence);
+    if (this->rotation_time() <= log_clock::now()) {
+        block_->rotation_time.store(rotation_time.time_since_epoch().count(),
+                                    std::memory_order_relaxed);
+    }
+}
+
+SPDLOG_INLINE std::uint64_t shared_rotation::next_sequence() { return ++block_->sequence; }
+
+SPDLOG_INLINE void shared_rotation::record_backup(const backup_file &file) {
+    shared_backup_record &record =
+        block_->history[file.sequence % shared_rotation_block::HistorySize];
+    if (file.filename.size() >= sizeof(record.name)) {
+        record.sequence = 0;
+        return;
+    }
+    record.sequence = file.sequence;
+    record.time = static_cast<std::int64_t>(file.time);
+    record.size = file.size;
+    std::memcpy(record.name, file.filename.c_str(), file.filename.size() + 1);
+}
+
+SPDLOG_INLINE bool shared_rotation::read_backups(std::uint64_t after,
+                                                 std::uint64_t before,
+                                                 std::vector<backup_file> &out) const {
+    for (std::uint64_t sequence = after + 1; sequence < before; ++sequence) {
+        const shared_backup_record &record =
+            block_->history[sequence % shared_rotation_block::HistorySize];
+        if (record.sequence != sequence) {
+            return false;
+        }
+        out.push_back({filename_t(record.name), static_cast<std::time_t>(record.time),
+                       static_cast<std::size_t>(record.size), sequence});
+    }
+    return true;
+}
+
+SPDLOG_INLINE void shared_rotation::rotated(log_clock::time_point rotation_time) {
+    block_->size.store(0, std::memory_order_relaxed);
+    block_->rotation_time.store(rotation_time.time_since_epoch().count(),
+                                std::memory_order_relaxed);
+    block_->generation.fetch_add(1, std::memory_order_release);
+}
+
+SPDLOG_INLINE void shared_rotation::reset(std::uint64_t file_size) {
+    block_->size.store(file_size, std::memory_order_relaxed);
+    block_->generation.fetch_add(1, std::memory_order_release);
+}
+#endif
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/backup_catalog.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+struct shared_rotation_block;
+
+/*
+ * 多进程共享的轮转状态：内存映射的控制文件（"<base>.ctl"），保存当前文件的大小、轮转代数、
+ * 下一个日期轮转时间、备份序号、最近的备份记录和一个进程间的互斥锁（Linux下为robust锁，
+ * 持有者崩溃后可恢复）；执行轮转的进程从备份记录中登记其他进程产生的备份，不必扫描目录
+ * 记录经以O_APPEND打开的写入句柄整条写出（一次write），写入方只对大小做原子累加，
+ * 锁只在轮转（改名和打开新文件）时持有；其他进程发现代数变化后重新打开当前文件
+ * 控制文件在首次使用时由持有文件锁（flock）的进程初始化，布局不兼容（其他构建创建）时构造抛出异常；
+ * Windows下不支持（构造时抛出异常）
+ */
+class shared_rotation {
+public:
+    explicit shared_rotation(const filename_t &control_filename);
+    ~shared_rotation();
+
+    shared_rotation(const shared_rotation &) = delete;
+    shared_rotation &operator=(const shared_rotation &) = delete;
+
+    /* 加锁；上一个持有者在持锁时退出则恢复锁并返回true（此时控制块的状态可能不完整） */
+    bool lock();
+    void unlock();
+
+    /* 打开（或重新打开）当前文件的写入句柄 */
+    void open_file(const filename_t &filename);
+    /* 一次追加写入并累加共享的大小，失败时抛出异常 */
+    void write(const char *data, std::size_t size);
+
+    std::uint64_t generation() const;
+    std::uint64_t size() const;
+    log_clock::time_point rotation_time() const;
+
+    /* 以下在持锁时调用 */
+    /* 加入：共享的大小落后于实际大小时补齐，备份序号取较大者，日期轮转时间已过期时更新 */
+    void attach(std::uint64_t file_size,
+                std::uint64_t sequence,
+                log_clock::time_point rotation_time);
+    std::uint64_t next_sequence();
+    /* 记录轮转产生的备份（filename不含目录，过长时不记录，读取方会退回扫描目录） */
+    void record_backup(const backup_file &file);
+    /* 读出序号在(after, before)之间的备份记录（文件名不含目录）；
+       有记录已被覆盖或未记录时返回false */
+    bool read_backups(std::uint64_t after,
+                      std::uint64_t before,
+                      std::vector<backup_file> &out) const;
+    /* 完成轮转：大小清零、代数加一，更新下一个日期轮转时间 */
+    void rotated(log_clock::time_point rotation_time);
+    /* 恢复崩溃前未完成的轮转：大小以实际大小为准，代数加一使所有进程重新打开当前文件 */
+    void reset(std::uint64_t file_size);
+
+private:
+    filename_t filename_;
+    shared_rotation_block *block_ = nullptr;
+    int fd_ = -1; /* 写入句柄 */
+};
+
+/* 持有shared_rotation的锁 */
+class shared_rotation_lock {
+public:
+    explicit shared_rotation_lock(shared_rotation &rotation)
+        : rotation_(rotation),
+          recovered_(rotation.lock()) {}
+    ~shared_rotation_lock() { rotation_.unlock(); }
+
+    shared_rotation_lock(const shared_rotation_lock &) = delete;
+    shared_rotation_lock &operator=(const shared_rotation_lock &) = delete;
+
+    bool recovered() const { return recovered_; }
+
+private:
+    shared_rotation &rotation_;
+    bool recovered_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "shared_rotation-inl.h"
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/sink_metrics.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE latency_histogram::latency_histogram() {
+    for (auto &bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+SPDLOG_INLINE void latency_histogram::record(std::chrono::steady_clock::duration elapsed) {
+    auto count = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    auto ns = static_cast<std::uint64_t>(count > 0 ? count : 0);
+    std::size_t bucket = 0;
+    for (std::uint64_t v = ns; v != 0 && bucket + 1 < Buckets; v >>= 1) {
+        ++bucket;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE latency_histogram::snapshot latency_histogram::get() const {
+    snapshot s;
+    s.count = 0;
+    for (std::size_t i = 0; i < Buckets; ++i) {
+        s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        s.count += s.buckets[i];
+    }
+    s.total_ns = total_ns_.load(std::memory_order_relaxed);
+    return s;
+}
+
+SPDLOG_INLINE std::uint64_t latency_histogram::snapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto target = static_cast<std::uint64_t>(q * static_cast<double>(count));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < Buckets; ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            return i == 0 ? 0 : (std::uint64_t(1) << i) - 1;
+        }
+    }
+    return (std::uint64_t(1) << (Buckets - 1)) - 1;
+}
+
+SPDLOG_INLINE void sink_metrics::add_record() {
+    records_written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void sink_metrics::add_bytes(std::size_t bytes) {
+    bytes_written_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void sink_metrics::add_rotation(bool by_date) {
+    (by_date ? rotations_by_date_ : rotations_by_size_).fetch_add(1, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void sink_metrics::add_rotate_time(clock::duration elapsed) {
+    rotate_ns_.fetch_add(static_cast<std::uint64_t>(
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                         std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void sink_metrics::add_clean_time(clock::duration elapsed) {
+    clean_ns_.fetch_add(static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                        std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void sink_metrics::add_files_deleted(std::size_t count) {
+    files_deleted_.fetch_add(count, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE sink_metrics_snapshot sink_metrics::snapshot() const {
+    sink_metrics_snapshot s;
+    s.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    s.records_written = records_written_.load(std::memory_order_relaxed);
+    s.rotations_by_size = rotations_by_size_.load(std::memory_order_relaxed);
+    s.rotations_by_date = rotations_by_date_.load(std::memory_order_relaxed);
+    s.rotate_ns = rotate_ns_.load(std::memory_order_relaxed);
+    s.clean_ns = clean_ns_.load(std::memory_order_relaxed);
+    s.files_deleted = files_deleted_.load(std::memory_order_relaxed);
+    s.lock_wait_ns = 0;
+    s.lock_hold_ns = 0;
+    s.write_latency = write_latency.get();
+    s.flush_latency = flush_latency.get();
+    return s;
+}
+
+SPDLOG_INLINE void metered_mutex::lock() {
+    auto start = clock::now();
+    mutex_.lock();
+    acquired_ = clock::now();
+    wait_ns_.fetch_add(static_cast<std::uint64_t>(
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(acquired_ - start)
+                               .count()),
+                       std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void metered_mutex::unlock() {
+    auto held = clock::now() - acquired_;
+    hold_ns_.fetch_add(static_cast<std::uint64_t>(
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(held).count()),
+                       std::memory_order_relaxed);
+    mutex_.unlock();
+}
+
+SPDLOG_INLINE bool metered_mutex::try_lock() {
+    if (!mutex_.try_lock()) {
+        return false;
+    }
+    acquired_ = clock::now();
+    return true;
+}
+
+SPDLOG_INLINE std::uint64_t metered_mutex::wait_ns() const {
+    return wait_ns_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE std::uint64_t metered_mutex::hold_ns() const {
+    return hold_ns_.load(std::memory_order_relaxed);
+}
+
+}  // namespace details
+}  // namespace spdlog
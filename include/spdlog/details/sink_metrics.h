@@ -0,0 +1,125 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/*
+ * rotating_dately_file_sink的运行指标，定义SPDLOG_DATELY_METRICS后编译进sink，
+ * 未定义时sink中不含任何统计代码和成员
+ * 计数器均为relaxed原子变量，大多在sink锁内更新，读取快照不需要加锁
+ */
+#ifdef SPDLOG_DATELY_METRICS
+    #define SPDLOG_DATELY_METRICS_ONLY(...) __VA_ARGS__
+#else
+    #define SPDLOG_DATELY_METRICS_ONLY(...)
+#endif
+
+namespace spdlog {
+namespace details {
+
+/* 延迟直方图：按2的幂分桶（纳秒），第i个桶统计[2^(i-1), 2^i)，最后一个桶包含更大的值 */
+class latency_histogram {
+public:
+    static constexpr std::size_t Buckets = 40;
+
+    struct snapshot {
+        std::array<std::uint64_t, Buckets> buckets;
+        std::uint64_t count;
+        std::uint64_t total_ns;
+
+        /* 估计分位数（返回所在桶的上界，纳秒），q取0~1 */
+        std::uint64_t percentile(double q) const;
+    };
+
+    latency_histogram();
+
+    void record(std::chrono::steady_clock::duration elapsed);
+    snapshot get() const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, Buckets> buckets_;
+    std::atomic<std::uint64_t> total_ns_{0};
+};
+
+struct sink_metrics_snapshot {
+    std::uint64_t bytes_written;
+    std::uint64_t records_written;
+    std::uint64_t rotations_by_size;
+    std::uint64_t rotations_by_date;
+    std::uint64_t rotate_ns; /* rotate_()在日志线程中的耗时 */
+    std::uint64_t clean_ns;  /* 清理过期备份的耗时（启用维护线程时在该线程上） */
+    std::uint64_t files_deleted;
+    std::uint64_t lock_wait_ns; /* 以下两项仅在sink使用metered_mutex时统计 */
+    std::uint64_t lock_hold_ns;
+    latency_histogram::snapshot write_latency; /* 单条记录的轮转判断和写入 */
+    latency_histogram::snapshot flush_latency;
+};
+
+class sink_metrics {
+public:
+    using clock = std::chrono::steady_clock;
+
+    void add_record();
+    void add_bytes(std::size_t bytes);
+    void add_rotation(bool by_date);
+    void add_rotate_time(clock::duration elapsed);
+    void add_clean_time(clock::duration elapsed);
+    void add_files_deleted(std::size_t count);
+
+    latency_histogram write_latency;
+    latency_histogram flush_latency;
+
+    sink_metrics_snapshot snapshot() const;
+
+private:
+    std::atomic<std::uint64_t> bytes_written_{0};
+    std::atomic<std::uint64_t> records_written_{0};
+    std::atomic<std::uint64_t> rotations_by_size_{0};
+    std::atomic<std::uint64_t> rotations_by_date_{0};
+    std::atomic<std::uint64_t> rotate_ns_{0};
+    std::atomic<std::uint64_t> clean_ns_{0};
+    std::atomic<std::uint64_t> files_deleted_{0};
+};
+
+/*
+ * 统计等待时间和持有时间的互斥量，作为sink的Mutex参数使用：
+ *   rotating_dately_file_sink<details::metered_mutex>
+ */
+class metered_mutex {
+public:
+    using clock = std::chrono::steady_clock;
+
+    void lock();
+    void unlock();
+    bool try_lock();
+
+    std::uint64_t wait_ns() const;
+    std::uint64_t hold_ns() const;
+
+private:
+    std::mutex mutex_;
+    clock::time_point acquired_; /* 只在持锁期间访问 */
+    std::atomic<std::uint64_t> wait_ns_{0};
+    std::atomic<std::uint64_t> hold_ns_{0};
+};
+
+/* 从sink的互斥量收集锁统计，普通互斥量不做任何事 */
+template <typename Mutex>
+inline void collect_lock_metrics(const Mutex &, sink_metrics_snapshot &) {}
+
+inline void collect_lock_metrics(const metered_mutex &mutex, sink_metrics_snapshot &snapshot) {
+    snapshot.lock_wait_ns = mutex.wait_ns();
+    snapshot.lock_hold_ns = mutex.hold_ns();
+}
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "sink_metrics-inl.h"
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include <cstddef>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 写入前的流式编码（如压缩）：格式化后的记录经编码后写入日志文件
+ * 输出由若干可独立解码的帧组成，end_frame()结束当前帧并输出帧尾，
+ * sink在flush和轮转前调用，保证每个文件都是完整可读的
+ */
+class stream_encoder {
+public:
+    virtual ~stream_encoder() = default;
+
+    virtual void encode(const char *data, std::size_t size, memory_buf_t &out) = 0;
+    virtual void end_frame(memory_buf_t &out) = 0; /* 当前帧为空时不输出 */
+    virtual const char *extension() const = 0;      /* 备份文件名后缀，如".zst" */
+};
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/striped_formatter.h>
+#endif
+
+#include <spdlog/details/compiled_pattern.h>
+#include <spdlog/pattern_formatter.h>
+
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE striped_formatter::striped_formatter() {
+    /* 每个硬件线程一个格式化器副本 */
+    std::size_t slots = std::thread::hardware_concurrency();
+    if (slots == 0) {
+        slots = 1;
+    }
+    for (std::size_t i = 0; i < slots; ++i) {
+        std::unique_ptr<slot> s(new slot());
+        s->formatter = details::make_unique<spdlog::pattern_formatter>();
+        slots_.push_back(std::move(s));
+    }
+}
+
+SPDLOG_INLINE void striped_formatter::format(const log_msg &msg, memory_buf_t &dest) {
+    slot &s = *slots_[msg.thread_id % slots_.size()];
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.formatter->format(msg, dest);
+}
+
+SPDLOG_INLINE void striped_formatter::set_pattern(const std::string &pattern) {
+    for (auto &s : slots_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->formatter = make_pattern_formatter(pattern);
+    }
+}
+
+SPDLOG_INLINE void striped_formatter::set_formatter(
+    std::unique_ptr<spdlog::formatter> sink_formatter) {
+    for (auto &s : slots_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->formatter = sink_formatter->clone();
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/log_msg.h"
+#include "spdlog/formatter.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/*
+ * 按线程分组的格式化器：pattern_formatter缓存了时间等状态，不能并发使用，
+ * 因此每个硬件线程一个副本、一把锁，多个生产线程可以在sink锁之外并行格式化
+ */
+class striped_formatter {
+public:
+    striped_formatter();
+
+    void format(const log_msg &msg, memory_buf_t &dest);
+    void set_pattern(const std::string &pattern);
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter);
+
+private:
+    struct slot {
+        std::mutex mutex;
+        std::unique_ptr<spdlog::formatter> formatter;
+    };
+
+    std::vector<std::unique_ptr<slot>> slots_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "striped_formatter-inl.h"
+#endif
@@ -0,0 +1,292 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/time_index.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+namespace time_index_detail {
+
+static const char Magic[] = {'D', 'T', 'L', 'Y', 'I', 'D', 'X', '1'};
+static const std::size_t MagicSize = sizeof(Magic);
+static const std::size_t EntrySize = 16;
+
+inline void put_le(std::string &out, std::uint64_t value) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+inline std::uint64_t get_le(const char *data) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+inline bool ends_with(const filename_t &s, const char *suffix) {
+    std::size_t len = std::strlen(suffix);
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+/* 普通文件存在时返回true并输出大小 */
+inline bool regular_file_size(const filename_t &path, std::size_t &size) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data) ||
+        (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        return false;
+    }
+    size = static_cast<std::size_t>((static_cast<unsigned long long>(data.nFileSizeHigh) << 32) |
+                                    data.nFileSizeLow);
+    return true;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    return true;
+#endif
+}
+
+}  // namespace time_index_detail
+
+SPDLOG_INLINE filename_t time_index::sidecar_filename(const filename_t &log_filename) {
+    using time_index_detail::ends_with;
+
+    filename_t name = log_filename;
+    if (ends_with(name, ".gz")) {
+        name.resize(name.size() - 3);
+    } else if (ends_with(name, ".zst")) {
+        name.resize(name.size() - 4);
+    }
+    return name + SPDLOG_FILENAME_T(".idx");
+}
+
+SPDLOG_INLINE bool time_index::write(const filename_t &filename,
+                                     const std::vector<time_index_entry> &entries) {
+    using namespace time_index_detail;
+
+    std::string data(Magic, MagicSize);
+    data.reserve(MagicSize + entries.size() * EntrySize);
+    for (const auto &entry : entries) {
+        put_le(data, static_cast<std::uint64_t>(entry.time));
+        put_le(data, entry.offset);
+    }
+
+    std::FILE *out = std::fopen(filename.c_str(), "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), out) == data.size();
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) {
+        std::remove(filename.c_str());
+    }
+    return ok;
+}
+
+SPDLOG_INLINE bool time_index::read(const filename_t &filename,
+                                    std::vector<time_index_entry> &entries) {
+    using namespace time_index_detail;
+
+    std::FILE *in = std::fopen(filename.c_str(), "rb");
+    if (in == nullptr) {
+        return false;
+    }
+    std::string data;
+    char chunk[64 * 1024];
+    std::size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.append(chunk, n);
+    }
+    std::fclose(in);
+
+    if (data.size() < MagicSize || !std::equal(Magic, Magic + MagicSize, data.begin())) {
+        return false;
+    }
+
+    entries.clear();
+    entries.reserve((data.size() - MagicSize) / EntrySize);
+    for (std::size_t pos = MagicSize; pos + EntrySize <= data.size(); pos += EntrySize) {
+        entries.push_back({static_cast<std::int64_t>(get_le(data.data() + pos)),
+                           get_le(data.data() + pos + 8)});
+    }
+    return true;
+}
+
+SPDLOG_INLINE std::int64_t time_index::to_index_time(log_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
+}
+
+SPDLOG_INLINE time_index_reader::time_index_reader(filename_t base_filename,
+                                                  filename_t backup_prefix)
+    : base_filename_(std::move(base_filename)),
+      naming_(std::move(backup_prefix)) {
+    size_t pos = base_filename_.find_last_of("/\\");
+    if (pos != filename_t::npos) {
+        directory_ = base_filename_.substr(0, pos);
+    }
+}
+
+SPDLOG_INLINE std::vector<log_byte_range> time_index_reader::find(log_clock::time_point from,
+                                                                  log_clock::time_point to) const {
+    using time_index_detail::regular_file_size;
+
+    std::int64_t from_time = time_index::to_index_time(from);
+    std::int64_t to_time = time_index::to_index_time(to);
+
+    std::vector<log_byte_range> ranges;
+    std::vector<indexed_file> files = load_indexes_();
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const indexed_file &file = files[i];
+
+        /* 文件覆盖的时间段：[首个条目, 下一个文件的首个条目)；
+           没有索引的当前文件从上一个文件的最后一个条目开始 */
+        std::int64_t start = (std::numeric_limits<std::int64_t>::min)();
+        if (!file.entries.empty()) {
+            start = file.entries.front().time;
+        } else if (i > 0) {
+            start = files[i - 1].entries.back().time;
+        }
+        std::int64_t next = (std::numeric_limits<std::int64_t>::max)();
+        if (i + 1 < files.size() && !files[i + 1].entries.empty()) {
+            next = files[i + 1].entries.front().time;
+        }
+        if (start > to_time || next < from_time) {
+            continue;
+        }
+
+        /* 起点对齐到不晚于from的最后一个条目，终点对齐到晚于to的第一个条目 */
+        std::size_t begin = 0;
+        auto first_after_from = std::partition_point(
+            file.entries.begin(), file.entries.end(),
+            [&](const time_index_entry &entry) { return entry.time <= from_time; });
+        if (first_after_from != file.entries.begin()) {
+            begin = static_cast<std::size_t>((first_after_from - 1)->offset);
+        }
+
+        std::size_t end = log_byte_range::npos;
+        auto first_after_to = std::partition_point(
+            file.entries.begin(), file.entries.end(),
+            [&](const time_index_entry &entry) { return entry.time <= to_time; });
+        std::size_t file_size = 0;
+        if (first_after_to != file.entries.end()) {
+            end = static_cast<std::size_t>(first_after_to->offset);
+        } else if (!file.compressed && regular_file_size(file.filename, file_size)) {
+            end = file_size;
+        }
+
+        if (begin < end) {
+            ranges.push_back({file.filename, begin, end});
+        }
+    }
+    return ranges;
+}
+
+/* 读入目录下全部备份索引（按首个条目的时间排序），当前文件排在最后 */
+SPDLOG_INLINE std::vector<time_index_reader::indexed_file> time_index_reader::load_indexes_()
+    const {
+    using time_index_detail::regular_file_size;
+
+    /* 只接受明文备份的索引 "<备份名>.log.idx" */
+    std::vector<filename_t> sidecars;
+    auto add_sidecar = [&](const filename_t &name, const filename_t &path) {
+        backup_stamp stamp;
+        std::size_t suffix_pos;
+        if (naming_.parse(name, stamp, suffix_pos) &&
+            name.compare(suffix_pos, filename_t::npos, SPDLOG_FILENAME_T(".idx")) == 0) {
+            sidecars.push_back(path);
+        }
+    };
+#ifdef _WIN32
+    WIN32_FIND_DATAA find_data;
+    filename_t pattern = (directory_.empty() ? filename_t(".") : directory_) + "\\" +
+                         naming_.prefix() + "*.log.idx";
+    HANDLE hFind = FindFirstFileA(pattern.c_str(), &find_data);
+    if (hFind != INVALID_HANDLE_VALUE) {
+        do {
+            if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                add_sidecar(find_data.cFileName, directory_.empty()
+                                                     ? filename_t(find_data.cFileName)
+                                                     : directory_ + "\\" + find_data.cFileName);
+            }
+        } while (FindNextFileA(hFind, &find_data) != 0);
+        FindClose(hFind);
+    }
+#else
+    DIR *dir = opendir(directory_.empty() ? "." : directory_.c_str());
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            filename_t name(entry->d_name);
+            add_sidecar(name, directory_.empty() ? name : directory_ + "/" + name);
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::vector<indexed_file> files;
+    std::size_t size = 0;
+    for (const auto &sidecar : sidecars) {
+        indexed_file file;
+        file.compressed = false;
+        if (!time_index::read(sidecar, file.entries) || file.entries.empty()) {
+            continue;
+        }
+
+        /* 日志文件可能已被压缩 */
+        filename_t log_filename = sidecar.substr(0, sidecar.size() - 4);
+        if (regular_file_size(log_filename, size)) {
+            file.filename = log_filename;
+        } else if (regular_file_size(log_filename + ".gz", size)) {
+            file.filename = log_filename + ".gz";
+            file.compressed = true;
+        } else if (regular_file_size(log_filename + ".zst", size)) {
+            file.filename = log_filename + ".zst";
+            file.compressed = true;
+        } else {
+            continue; /* 备份已被清理，只剩残留的索引 */
+        }
+        files.push_back(std::move(file));
+    }
+    std::sort(files.begin(), files.end(), [](const indexed_file &a, const indexed_file &b) {
+        return a.entries.front().time < b.entries.front().time;
+    });
+
+    if (regular_file_size(base_filename_, size)) {
+        indexed_file live;
+        live.filename = base_filename_;
+        live.compressed = false;
+        if (!time_index::read(time_index::sidecar_filename(base_filename_), live.entries)) {
+            live.entries.clear();
+        }
+        /* 丢弃超出当前文件大小的条目（索引写出后文件又被截断） */
+        while (!live.entries.empty() && live.entries.back().offset > size) {
+            live.entries.pop_back();
+        }
+        files.push_back(std::move(live));
+    }
+    return files;
+}
+
+}  // namespace details
+}  // namespace spdlog
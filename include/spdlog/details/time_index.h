@@ -0,0 +1,82 @@
+#pragma once
+
+#include "spdlog/common.h"
+#include "spdlog/details/backup_name.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+/* 稀疏时间索引条目：记录时间（微秒，log_clock纪元）和该记录在日志文件中的字节偏移 */
+struct time_index_entry {
+    std::int64_t time;
+    std::uint64_t offset;
+};
+
+/*
+ * 日志文件的时间索引（旁路文件 "<日志文件>.idx"）
+ * sink每写出N字节或每隔一段时间记录一个条目，轮转时随备份一起落盘，
+ * 按时间查日志时只需读索引并定位到少量字节范围，不必扫描整个文件
+ *
+ * 文件格式：8字节魔数 "DTLYIDX1"，之后是若干个16字节条目
+ *   i64 时间(微秒) | u64 偏移
+ * 整数均为小端序，末尾不完整的条目会被忽略
+ */
+class time_index {
+public:
+    /* 日志文件对应的索引文件名；压缩后的备份（.gz/.zst）沿用压缩前的索引 */
+    static filename_t sidecar_filename(const filename_t &log_filename);
+
+    static bool write(const filename_t &filename, const std::vector<time_index_entry> &entries);
+    static bool read(const filename_t &filename, std::vector<time_index_entry> &entries);
+
+    static std::int64_t to_index_time(log_clock::time_point tp);
+};
+
+/* 查询结果：日志文件及其中覆盖查询时间段的字节范围[begin, end) */
+struct log_byte_range {
+    static constexpr std::size_t npos = (std::numeric_limits<std::size_t>::max)();
+
+    filename_t filename;
+    std::size_t begin;
+    std::size_t end; /* 压缩备份的偏移对应解压后的数据，end为npos表示读到末尾 */
+};
+
+/*
+ * 按时间段定位日志：读取sink目录下全部索引（备份的 "<备份名>.log.idx" 和当前文件的索引），
+ * 返回按时间排序的（文件，字节范围）列表
+ * 每个文件覆盖从其第一个索引条目到下一个文件第一个条目之间的时间；
+ * 索引是稀疏的，范围向外对齐到相邻条目，调用方读取后仍需按记录时间过滤
+ * 没有索引的备份无法定位，不会出现在结果中；
+ * 当前文件的索引只在sink关闭时写出，缺失时当前文件按整个文件返回
+ */
+class time_index_reader {
+public:
+    explicit time_index_reader(filename_t base_filename,
+                               filename_t backup_prefix = SPDLOG_FILENAME_T("app_"));
+
+    std::vector<log_byte_range> find(log_clock::time_point from, log_clock::time_point to) const;
+
+private:
+    struct indexed_file {
+        filename_t filename;
+        std::vector<time_index_entry> entries;
+        bool compressed;
+    };
+
+    std::vector<indexed_file> load_indexes_() const;
+
+    filename_t base_filename_;
+    filename_t directory_;
+    backup_name naming_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "time_index-inl.h"
+#endif
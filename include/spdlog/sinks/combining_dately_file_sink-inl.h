@@ -0,0 +1,147 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/sinks/combining_dately_file_sink.h>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+
+namespace spdlog {
+namespace sinks {
+
+SPDLOG_INLINE combining_dately_file_sink::combining_dately_file_sink(
+    const filename_t &base_filename,
+    std::chrono::hours max_age,
+    std::size_t max_size,
+    std::size_t max_files,
+    bool truncate,
+    std::size_t queue_size,
+    const file_event_handlers &event_handlers)
+    : dately_sink_(std::make_shared<rotating_dately_file_sink_mt>(
+          base_filename, max_age, max_size, max_files, truncate, event_handlers)),
+      ring_(queue_size) {
+    dately_sink_->preformatted_only_ = true;
+    dately_sink_->set_write_combining(DefaultCombineSize);
+    drainer_ = std::thread(&combining_dately_file_sink::drain_loop_, this);
+}
+
+SPDLOG_INLINE combining_dately_file_sink::~combining_dately_file_sink() {
+    {
+        /* 持锁设置，写线程检查停止标志和进入等待之间不会错过通知 */
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_.store(true, std::memory_order_release);
+    }
+    wake_cv_.notify_one();
+    if (drainer_.joinable()) {
+        drainer_.join();
+    }
+    dately_sink_->flush();
+}
+
+SPDLOG_INLINE void combining_dately_file_sink::log(const details::log_msg &msg) {
+    /* 在任何锁之外格式化到线程局部缓冲区 */
+    static thread_local memory_buf_t formatted;
+    formatted.clear();
+    formatter_.format(msg, formatted);
+
+    /* 队列满时唤醒写线程并等待它写出一批，形成背压；写线程持锁通知，不会错过 */
+    if (!ring_.try_push(msg.time, formatted)) {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (!ring_.try_push(msg.time, formatted)) {
+            wake_cv_.notify_one();
+            drained_cv_.wait(lock);
+        }
+    }
+
+    /* 与写线程的parked_/队列检查配对：要么写线程看到这条记录，要么这里看到它已停下 */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+SPDLOG_INLINE void combining_dately_file_sink::flush() {
+    std::size_t target = ring_.pushed();
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (ring_.consumed() < target) {
+            wake_cv_.notify_one();
+            drained_cv_.wait(lock);
+        }
+    }
+    dately_sink_->flush();
+}
+
+SPDLOG_INLINE void combining_dately_file_sink::set_pattern(const std::string &pattern) {
+    formatter_.set_pattern(pattern);
+}
+
+SPDLOG_INLINE void combining_dately_file_sink::set_formatter(
+    std::unique_ptr<spdlog::formatter> sink_formatter) {
+    formatter_.set_formatter(std::move(sink_formatter));
+}
+
+SPDLOG_INLINE std::shared_ptr<rotating_dately_file_sink_mt>
+combining_dately_file_sink::dately_sink() const {
+    return dately_sink_;
+}
+
+SPDLOG_INLINE void combining_dately_file_sink::drain_loop_() {
+    for (;;) {
+        /* 先读停止标志再取队列，保证退出前队列中的记录都已写出 */
+        bool stopping = stop_.load(std::memory_order_acquire);
+        if (drain_() != 0) {
+            /* 持锁通知，等待方检查进度和进入等待之间不会错过 */
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            drained_cv_.notify_all();
+            continue;
+        }
+        if (stopping) {
+            return;
+        }
+
+        /* 队列为空时停下，直到生产线程、flush或析构唤醒；
+           先声明停下再检查队列，期间写入的记录由写入方看到parked_后通知 */
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring_.pushed() == ring_.consumed() && !stop_.load(std::memory_order_acquire)) {
+            wake_cv_.wait(lock);
+        }
+        parked_.store(false, std::memory_order_relaxed);
+    }
+}
+
+/* 取出一批记录逐条写入（轮转判断在每条记录之前），最后合并写出 */
+SPDLOG_INLINE std::size_t combining_dately_file_sink::drain_() {
+    std::size_t count = 0;
+    std::lock_guard<std::mutex> lock(dately_sink_->mutex_);
+
+    auto write_record = [this](log_clock::time_point time, const memory_buf_t &record) {
+        try {
+            dately_sink_->write_formatted_(time, record);
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "[*** LOG ERROR ***] combining_dately_file_sink: %s\n",
+                         ex.what());
+        }
+    };
+    while (count < MaxDrainBatch && ring_.try_consume(write_record)) {
+        ++count;
+    }
+
+    if (count != 0) {
+        try {
+            dately_sink_->flush_combined_();
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "[*** LOG ERROR ***] combining_dately_file_sink: %s\n",
+                         ex.what());
+        }
+    }
+    return count;
+}
+
+}  // namespace sinks
+}  // namespace spdlog
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "spdlog/details/mpsc_record_ring.h"
+#include "spdlog/details/striped_formatter.h"
+#include "spdlog/sinks/rotating_dately_file_sink.h"
+#include "spdlog/sinks/sink.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * 合并写的rotating_dately_file_sink：生产线程在锁外格式化后写入无锁环形队列，
+ * 由单个写线程批量取出，逐条做大小/日期轮转判断后合并成整块，每批一次write写出（组提交）
+ * 轮转边界总在记录之间，不会拆分记录
+ * 格式通过本对象的set_pattern/set_formatter设置，其余配置通过dately_sink()设置（不支持二进制格式和重复抑制）
+ */
+class combining_dately_file_sink final : public sink {
+public:
+    explicit combining_dately_file_sink(const filename_t &base_filename,
+                                        std::chrono::hours max_age = std::chrono::hours(24 * 30),
+                                        std::size_t max_size = 1024 * 1024 * 10,
+                                        std::size_t max_files = 0,
+                                        bool truncate = false,
+                                        std::size_t queue_size = 8192,
+                                        const file_event_handlers &event_handlers = {});
+    ~combining_dately_file_sink() override; /* 写出队列中剩余的记录后退出 */
+
+    void log(const details::log_msg &msg) override;
+    void flush() override; /* 等待此前写入队列的记录全部写出后再刷新文件 */
+    void set_pattern(const std::string &pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    /* 底层的轮转sink，用于设置大小、数量、合并块大小、维护线程等 */
+    std::shared_ptr<rotating_dately_file_sink_mt> dately_sink() const;
+
+private:
+    static constexpr std::size_t MaxDrainBatch = 1024; /* 每次持锁最多写出的记录数 */
+    static constexpr std::size_t DefaultCombineSize = 64 * 1024;
+
+    void drain_loop_();
+    std::size_t drain_();
+
+    std::shared_ptr<rotating_dately_file_sink_mt> dately_sink_;
+    details::striped_formatter formatter_;
+    details::mpsc_record_ring ring_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> parked_{false}; /* 写线程因队列为空而等待，写入后需要唤醒它 */
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;    /* 唤醒写线程 */
+    std::condition_variable drained_cv_; /* 写线程写出一批后通知等待的flush和生产线程 */
+    std::thread drainer_;
+};
+
+}  // namespace sinks
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "combining_dately_file_sink-inl.h"
+#endif
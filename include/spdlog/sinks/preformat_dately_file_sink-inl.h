@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/sinks/preformat_dately_file_sink.h>
+#endif
+
+namespace spdlog {
+namespace sinks {
+
+SPDLOG_INLINE preformat_dately_file_sink::preformat_dately_file_sink(
+    const filename_t &base_filename,
+    std::chrono::hours max_age,
+    std::size_t max_size,
+    std::size_t max_files,
+    bool truncate,
+    const file_event_handlers &event_handlers)
+    : dately_sink_(std::make_shared<rotating_dately_file_sink_mt>(
+          base_filename, max_age, max_size, max_files, truncate, event_handlers)) {
+    dately_sink_->preformatted_only_ = true;
+}
+
+SPDLOG_INLINE void preformat_dately_file_sink::log(const details::log_msg &msg) {
+    /* 在sink锁之外格式化到线程局部缓冲区 */
+    static thread_local memory_buf_t formatted;
+    formatted.clear();
+    formatter_.format(msg, formatted);
+
+    std::lock_guard<std::mutex> lock(dately_sink_->mutex_);
+    dately_sink_->write_formatted_(msg.time, formatted);
+}
+
+SPDLOG_INLINE void preformat_dately_file_sink::flush() {
+    dately_sink_->flush();
+}
+
+SPDLOG_INLINE void preformat_dately_file_sink::set_pattern(const std::string &pattern) {
+    formatter_.set_pattern(pattern);
+}
+
+SPDLOG_INLINE void preformat_dately_file_sink::set_formatter(
+    std::unique_ptr<spdlog::formatter> sink_formatter) {
+    formatter_.set_formatter(std::move(sink_formatter));
+}
+
+SPDLOG_INLINE std::shared_ptr<rotating_dately_file_sink_mt>
+preformat_dately_file_sink::dately_sink() const {
+    return dately_sink_;
+}
+
+}  // namespace sinks
+}  // namespace spdlog
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "spdlog/details/striped_formatter.h"
+#include "spdlog/sinks/rotating_dately_file_sink.h"
+#include "spdlog/sinks/sink.h"
+#include <memory>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * rotating_dately_file_sink_mt的变体：在sink锁之外格式化日志，
+ * 锁内只做大小/日期轮转判断和追加写入
+ * 格式化器按线程分组（见details::striped_formatter），多个生产线程可以并行格式化
+ * 格式通过本对象的set_pattern/set_formatter设置，其余配置通过dately_sink()设置（不支持二进制格式和重复抑制）
+ */
+class preformat_dately_file_sink final : public sink {
+public:
+    explicit preformat_dately_file_sink(const filename_t &base_filename,
+                                        std::chrono::hours max_age = std::chrono::hours(24 * 30),
+                                        std::size_t max_size = 1024 * 1024 * 10,
+                                        std::size_t max_files = 0,
+                                        bool truncate = false,
+                                        const file_event_handlers &event_handlers = {});
+
+    void log(const details::log_msg &msg) override;
+    void flush() override;
+    void set_pattern(const std::string &pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    /* 底层的轮转sink，用于设置大小、数量、维护线程等 */
+    std::shared_ptr<rotating_dately_file_sink_mt> dately_sink() const;
+
+private:
+    std::shared_ptr<rotating_dately_file_sink_mt> dately_sink_;
+    details::striped_formatter formatter_;
+};
+
+}  // namespace sinks
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "preformat_dately_file_sink-inl.h"
+#endif
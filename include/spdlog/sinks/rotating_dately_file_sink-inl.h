@@ -18,8 +18,7 @@
 #include <cstdio>
 #include <vector>
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <unordered_map>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -213,19 +212,23 @@ rotating_dately_file_sink<Mutex>::get_file_modification_time(const filename_t &p
 #endif
 }
 
-/* 辅助函数：从文件名中提取时间 */
+/* 辅助函数：获取文件大小 */
 template <typename Mutex>
-SPDLOG_INLINE std::time_t rotating_dately_file_sink<Mutex>::extract_time_from_filename(
-    const filename_t &filename) {
-    /* 假设文件名格式为 "app_YYYYmmdd_HHMMSS.log" */
-    size_t start_pos = filename.find("app_") + 4;
-    size_t end_pos = filename.find(".log");
-    std::string time_str = filename.substr(start_pos, end_pos - start_pos);
-
-    std::tm tm = {};
-    std::istringstream ss(time_str);
-    ss >> std::get_time(&tm, "%Y%m%d_%H%M%S");
-    return std::mktime(&tm);
+SPDLOG_INLINE std::size_t rotating_dately_file_sink<Mutex>::get_file_size(const filename_t &path) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+    return static_cast<std::size_t>((static_cast<unsigned long long>(data.nFileSizeHigh) << 32) |
+                                    data.nFileSizeLow);
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(st.st_size);
+#endif
 }
 
 template <typename Mutex>
@@ -235,14 +238,18 @@ SPDLOG_INLINE rotating_dately_file_sink<Mutex>::rotating_dately_file_sink(
     std::size_t max_size,
     std::size_t max_files,
     bool truncate,
-    const file_event_handlers &event_handlers)
+    const file_event_handlers &event_handlers,
+    bool use_manifest,
+    const filename_t &backup_prefix)
     : base_filename_(std::move(base_filename)),
+      naming_(backup_prefix),
       max_age_(max_age),
       max_size_(max_size),
       max_files_(max_files),
       truncate_(truncate),
-      file_helper_{event_handlers},
-      filenames_q_(),
+      file_helper_(new details::file_helper(event_handlers)),
+      event_handlers_(event_handlers),
+      backups_(),
       current_size_(0) {
     if (max_size == 0) {
         throw_spdlog_ex("rotating_dately_file_sink_new constructor: max_size arg cannot be zero");
@@ -263,16 +270,68 @@ SPDLOG_INLINE rotating_dately_file_sink<Mutex>::rotating_dately_file_sink(
     }
 
     /* 打开当前日志文件（使用原始文件名） */
-    file_helper_.open(base_filename_, truncate_);
-    rotation_tp_ = next_rotation_tp_();
-    current_size_ = file_helper_.size();
-
-    if (max_files_ > 0) {
-        init_filenames_q_();
+    file_helper_->open(base_filename_, truncate_);
+    rotation_tp_ = schedule_.next_boundary(log_clock::now());
+    current_size_ = file_helper_->size();
+
+    /* 读入备份清单或扫描一次目录建立备份目录，之后由rotate_()增量维护 */
+    if (use_manifest) {
+        manifest_.reset(new details::backup_manifest(
+            base_filename_ + SPDLOG_FILENAME_T(".manifest"), directory_));
     }
+    bool unverified = init_backup_catalog_();
 
     /* 手动调用一次清理函数,防止软件在不会持续运行到第二天时一直不执行清理 */
     clean_old_files();
+    catalog_unverified_ = unverified;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE rotating_dately_file_sink<Mutex>::~rotating_dately_file_sink() {
+    /* 补写尚未写出的抑制汇总，可能触发轮转，因此在等待维护任务之前 */
+    if (suppressor_) {
+        try {
+            write_idle_summaries_(log_clock::now(), true);
+        } catch (...) {
+        }
+    }
+
+    /* 维护任务和后处理回调引用了本对象，析构前必须等待其完成
+       （维护任务可能提交后处理，后处理回调又会提交维护任务） */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+    if (processor_) {
+        processor_->wait_idle();
+        if (maintenance_) {
+            maintenance_->wait_idle();
+        }
+    }
+    drop_standby_();
+
+    /* 结束编码帧并写出合并缓冲区中剩余的记录，析构中不能抛出异常 */
+    try {
+        end_frame_();
+        flush_combined_();
+        if (sync_file_ || tuner_) {
+            file_helper_->flush();
+            if (writer_) {
+                writer_->drain();
+            }
+        }
+        if (sync_file_) {
+            commit_.wait(commit_.mark());
+        }
+        if (tuner_) {
+            tuner_->release_space();
+        }
+    } catch (...) {
+    }
+
+    /* 写出当前文件的索引，下次启动时继续追加 */
+    if (index_every_bytes_ != 0 && !index_.empty()) {
+        details::time_index::write(details::time_index::sidecar_filename(base_filename_), index_);
+    }
 }
 
 template <typename Mutex>
@@ -303,19 +362,53 @@ SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_max_files(std::size_t m
             "rotating_dately_file_sink_new set_max_files: max_files arg cannot exceed 200000");
     }
     max_files_ = max_files;
-    if (max_files_ > 0) {
-        init_filenames_q_();
-    }
     clean_old_files();
 }
 
-/* 设置日志格式 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_max_total_size(
+    std::size_t max_total_size) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    max_total_size_ = max_total_size;
+    clean_old_files();
+}
+
+/* 设置日志格式：常用flag组成的pattern按执行步骤直接输出，其余退回spdlog::pattern_formatter */
 template <typename Mutex>
 SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_dately_file_pattern(
     const std::string &pattern) {
     std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-    base_sink<Mutex>::formatter_ =
-        std::unique_ptr<spdlog::formatter>(new spdlog::pattern_formatter(pattern));
+    base_sink<Mutex>::formatter_ = details::make_pattern_formatter(pattern);
+    own_formatter_ = true;
+}
+
+#ifdef SPDLOG_DATELY_STATIC_PATTERN
+template <typename Mutex>
+template <details::pattern_string Pattern>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_dately_file_pattern() {
+    if constexpr (details::static_pattern_formatter<Pattern>::plan.supported) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        base_sink<Mutex>::formatter_ = std::unique_ptr<spdlog::formatter>(
+            new details::static_pattern_formatter<Pattern>());
+        own_formatter_ = true;
+    } else {
+        set_dately_file_pattern(std::string(Pattern.data));
+    }
+}
+#endif
+
+/* 通过set_pattern/set_formatter设置格式（base_sink已持有锁） */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_pattern_(const std::string &pattern) {
+    base_sink<Mutex>::set_pattern_(pattern);
+    own_formatter_ = true;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_formatter_(
+    std::unique_ptr<spdlog::formatter> sink_formatter) {
+    base_sink<Mutex>::set_formatter_(std::move(sink_formatter));
+    own_formatter_ = true;
 }
 
 /* 修改当前日志文件名 */
@@ -324,8 +417,25 @@ SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_current_filename(
     const filename_t &new_filename) {
     std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
 
+    /* 其他进程仍按原来的base_filename写入和轮转，改名会使各进程操作不同的文件 */
+    if (shared_) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: current filename cannot be changed in "
+                        "multi-process mode");
+    }
+
+    /* 待命文件的名字随当前文件名变化，先等待维护任务完成并丢弃旧的待命文件 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+    drop_standby_();
+
     /* 关闭当前文件 */
-    file_helper_.close();
+    end_frame_();
+    flush_combined_();
+    if (writer_) {
+        writer_->drain();
+    }
+    file_helper_->close();
 
     /* 构建新的完整路径 */
     filename_t new_full_path = directory_;
@@ -338,7 +448,7 @@ SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_current_filename(
     if (file_exists(base_filename_)) {
         if (!rename_file(base_filename_, new_full_path)) {
             /* 重命名失败，尝试再次打开原文件 */
-            file_helper_.open(base_filename_, truncate_);
+            file_helper_->open(base_filename_, truncate_);
             throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
                                 details::os::filename_to_str(base_filename_) + " to " +
                                 details::os::filename_to_str(new_full_path),
@@ -350,76 +460,840 @@ SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_current_filename(
     base_filename_ = new_full_path;
     base_filename_only_ = new_filename;
 
+    /* 飞行记录器的环形文件随之改名，保留已记录的内容（改名失败时旧文件留作恢复，新文件从头写） */
+    if (recorder_) {
+        std::size_t capacity = recorder_->capacity();
+        filename_t ring_filename = recorder_->filename();
+        recorder_.reset();
+        filename_t new_ring_filename = base_filename_ + SPDLOG_FILENAME_T(".ring");
+        rename_file(ring_filename, new_ring_filename);
+        recorder_.reset(new details::flight_recorder(new_ring_filename, capacity));
+    }
+
     /* 打开新文件 */
-    file_helper_.open(base_filename_, truncate_);
-    current_size_ = file_helper_.size();
+    file_helper_->open(base_filename_, truncate_);
+    current_size_ = file_helper_->size();
+    attach_file_handles_(base_filename_);
+
+    if (standby_enabled_) {
+        filename_t standby_filename = base_filename_ + SPDLOG_FILENAME_T(".next");
+        run_maintenance_([this, standby_filename] { prepare_standby_(standby_filename); });
+    }
+}
+
+/* 设置后台维护线程 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_maintenance_worker(
+    std::shared_ptr<details::maintenance_worker> worker) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+#ifndef _WIN32
+    if (!worker && writer_) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: async writer requires a maintenance "
+                        "worker");
+    }
+#endif
+
+    /* 切换前等待旧线程上的任务完成，保证备份目录不会被两个线程同时访问 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+    maintenance_ = std::move(worker);
+
+    /* 启动时读入的备份清单在新的维护线程上与目录核对，不等到第一次轮转 */
+    if (maintenance_ && catalog_unverified_) {
+        maintenance_->post([this] { reconcile_backup_catalog_(); });
+    }
+}
+
+/* 等待维护任务完成（不持有sink锁，避免阻塞日志线程） */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::wait_for_maintenance() {
+    std::shared_ptr<details::maintenance_worker> worker;
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        worker = maintenance_;
+    }
+    if (worker) {
+        worker->wait_idle();
+    }
+}
+
+/* 设置轮转后处理 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_backup_processor(
+    std::shared_ptr<details::backup_processor> processor) {
+    std::shared_ptr<details::backup_processor> old;
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        old = processor_;
+        processor_ = processor;
+    }
+
+    /* 旧的后处理回调引用本对象并会获取sink锁，在锁外等待：已提交的维护任务可能还会
+       提交后处理，后处理回调又会提交维护任务；否则析构时不再等待它们 */
+    if (old && old != processor) {
+        wait_for_maintenance();
+        old->wait_idle();
+        wait_for_maintenance();
+    }
+}
+
+/* 设置流式编码 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_stream_encoder(
+    std::unique_ptr<details::stream_encoder> encoder) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (encoder && binary_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: stream encoder cannot be combined with binary format");
+    }
+    if (encoder && shared_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: stream encoder cannot be combined with multi-process "
+            "mode");
+    }
+    if (encoder && writer_ && writer_->drop_on_overflow()) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: stream encoder cannot be combined with "
+                        "drop_on_overflow");
+    }
+
+    /* 维护任务会用后缀计算备份文件名 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+
+    end_frame_();
+    flush_combined_();
+    if (current_size_ > 0) {
+        rotate_();
+    }
+
+    encoder_ = std::move(encoder);
+    backup_suffix_ = encoder_ ? encoder_->extension() : "";
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+}
+
+/* 启用/关闭二进制记录模式 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_binary_format(bool enabled) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (enabled == (binary_ != nullptr)) {
+        return;
+    }
+    if (enabled && encoder_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: binary format cannot be combined with stream encoder");
+    }
+    if (enabled && shared_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: binary format cannot be combined with multi-process "
+            "mode");
+    }
+    if (enabled && writer_ && writer_->drop_on_overflow()) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: binary format cannot be combined with "
+                        "drop_on_overflow");
+    }
+    if (enabled && preformatted_only_) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: binary format is not available through "
+                        "preformat_dately_file_sink or combining_dately_file_sink");
+    }
+
+    /* 维护任务会用后缀计算备份文件名 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+
+    /* 每个文件只有一种格式（重启后当前文件可能已是二进制格式） */
+    flush_combined_();
+    if (current_size_ > 0) {
+        file_helper_->flush();
+        if (writer_) {
+            writer_->drain();
+        }
+        if (details::binary_record_decoder::is_binary_file(base_filename_) != enabled) {
+            rotate_();
+        }
+    }
+
+    binary_.reset(enabled ? new details::binary_record_encoder() : nullptr);
+    backup_suffix_ = enabled ? SPDLOG_FILENAME_T(".bin") : SPDLOG_FILENAME_T("");
+    index_.clear();
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+}
+
+/* 启用/关闭时间索引 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_time_index(
+    std::size_t every_bytes, std::chrono::milliseconds interval) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (every_bytes != 0 && shared_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: time index cannot be combined with multi-process mode");
+    }
+    bool was_enabled = index_every_bytes_ != 0;
+    index_every_bytes_ = every_bytes;
+    index_interval_ = interval;
+
+    if (every_bytes == 0) {
+        index_.clear();
+        return;
+    }
+    if (was_enabled) {
+        return;
+    }
+
+    /* 接着上次关闭时写出的索引继续，只保留仍在当前文件范围内的条目；
+       读入后删除，避免sink异常退出时留下与文件内容不符的索引 */
+    filename_t sidecar = details::time_index::sidecar_filename(base_filename_);
+    index_.clear();
+    if (details::time_index::read(sidecar, index_)) {
+        while (!index_.empty() && index_.back().offset > current_size_) {
+            index_.pop_back();
+        }
+        remove(sidecar.c_str());
+    }
+    if (!index_.empty()) {
+        index_last_offset_ = static_cast<std::size_t>(index_.back().offset);
+        index_last_time_ = log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(
+            std::chrono::microseconds(index_.back().time)));
+    }
+}
+
+/* 启用/关闭待命文件 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_standby_file(bool enabled) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+#ifdef _WIN32
+    (void)enabled;
+#else
+    if (enabled == standby_enabled_) {
+        return;
+    }
+    if (enabled && shared_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: standby file cannot be combined with multi-process "
+            "mode");
+    }
+    if (!enabled && writer_) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: async writer requires a standby file");
+    }
+    standby_enabled_ = enabled;
+
+    if (enabled) {
+        /* 上次异常退出时遗留的待命文件中可能有记录，先保留为备份，待命文件准备时会被截断 */
+        filename_t standby_filename = base_filename_ + SPDLOG_FILENAME_T(".next");
+        std::size_t leftover = get_file_size(standby_filename);
+        if (leftover != 0 && !salvage_standby_(standby_filename, leftover)) {
+            standby_enabled_ = false;
+            throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
+                                details::os::filename_to_str(standby_filename),
+                            errno);
+        }
+        run_maintenance_([this, standby_filename] { prepare_standby_(standby_filename); });
+    } else {
+        if (maintenance_) {
+            maintenance_->wait_idle();
+        }
+        drop_standby_();
+    }
+#endif
+}
+
+/* 设置合并写缓冲区 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_write_combining(
+    std::size_t buffer_size) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    flush_combined_();
+
+    if (buffer_size == 0) {
+        combine_limit_ = 0;
+        direct_.reset();
+        return;
+    }
+
+    /* 向上取整到文件系统块大小，使每次写入都是整块 */
+    std::size_t block_size = 4096;
+#ifndef _WIN32
+    struct stat st;
+    if (stat(base_filename_.c_str(), &st) == 0 && st.st_blksize > 0) {
+        block_size = static_cast<std::size_t>(st.st_blksize);
+    }
+#endif
+    combine_limit_ = (buffer_size + block_size - 1) / block_size * block_size;
+    combine_buf_.reserve(combine_limit_ + 1024);
+
+    /* 之后的写入绕过stdio，先写出file_helper中已缓冲的数据 */
+    if (!direct_) {
+        file_helper_->flush();
+        direct_.reset(new details::append_file(base_filename_));
+    }
+}
+
+/* 设置flush策略 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_flush_policy(
+    const details::flush_policy &policy) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+
+    /* 待命文件的重命名可能尚未完成，等待后再按文件名打开落盘句柄 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+    flush_policy_ = policy;
+    last_flush_time_ = log_clock::now();
+
+    if (policy.durable && !sync_file_) {
+        open_sync_file_(file_helper_->filename());
+    } else if (!policy.durable && sync_file_) {
+        /* 关闭前把已写入的记录落盘，不留下未同步的旧文件 */
+        std::uint64_t seq = flush_to_os_();
+        commit_.wait(seq);
+        sync_file_.reset();
+        commit_.set_file(nullptr);
+    }
+}
+
+/* 设置文件空间和页缓存管理 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_file_tuning(bool preallocate,
+                                                                     std::size_t evict_window) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+
+    /* 待命文件的重命名可能尚未完成，等待后再按文件名打开 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+    if (tuner_) {
+        tuner_->release_space();
+        tuner_.reset();
+    }
+    preallocate_ = preallocate && details::file_tuner::supported();
+    evict_window_ = details::file_tuner::supported() ? evict_window : 0;
+    if (preallocate_ || evict_window_ != 0) {
+        tuner_ = std::make_shared<details::file_tuner>(file_helper_->filename(),
+                                                       preallocate_ ? max_size_ : 0, evict_window_);
+    }
+}
+
+/* 设置异步写入 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_async_writer(std::size_t buffer_size,
+                                                                      std::size_t buffer_count,
+                                                                      bool drop_on_overflow) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (buffer_size != 0 && shared_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: async writer cannot be combined with multi-process "
+            "mode");
+    }
+    /* 丢弃会截断编码流，或丢掉二进制记录依赖的字符串定义 */
+    if (buffer_size != 0 && drop_on_overflow && (encoder_ || binary_)) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: drop_on_overflow cannot be combined with "
+                        "stream encoder or binary format");
+    }
+#ifndef _WIN32
+    /* 轮转时的文件操作不能在日志线程中同步进行 */
+    if (buffer_size != 0 && (!maintenance_ || !standby_enabled_)) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: async writer requires a maintenance "
+                        "worker and a standby file");
+    }
+#endif
+
+    /* 待命文件的重命名可能尚未完成，等待后再按文件名打开 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+
+    /* 切换前写完已有数据，两条写入路径不会交错 */
+    flush_combined_();
+    file_helper_->flush();
+    if (writer_) {
+        writer_->drain();
+        writer_.reset();
+    }
+    if (buffer_size != 0) {
+        writer_ = std::make_shared<details::async_file_writer>(buffer_size, buffer_count,
+                                                               drop_on_overflow);
+        writer_->open(file_helper_->filename());
+    }
 }
 
+/* 设置飞行记录器 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_flight_recorder(std::size_t capacity) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (capacity != 0 && shared_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: flight recorder cannot be combined with multi-process "
+            "mode");
+    }
+    recorder_.reset();
+    if (capacity != 0) {
+        recorder_.reset(new details::flight_recorder(base_filename_ + SPDLOG_FILENAME_T(".ring"),
+                                                     capacity));
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_suppression(
+    const details::suppression_policy &policy) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (policy.burst != 0 && preformatted_only_) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: suppression is not available through "
+                        "preformat_dately_file_sink or combining_dately_file_sink");
+    }
+    if (suppressor_) {
+        write_idle_summaries_(log_clock::now(), true);
+    }
+    suppressor_.reset();
+    if (policy.burst != 0) {
+        suppressor_.reset(new details::log_suppressor(policy));
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_rotation_schedule(
+    const details::rotation_schedule &schedule) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (shared_) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: rotation schedule must be set before "
+                        "multi-process mode");
+    }
+    schedule_ = schedule;
+    rotation_tp_ = schedule_.next_boundary(log_clock::now());
+}
+
+/* 启用/关闭多进程模式 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::set_multi_process(bool enabled) {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    if (enabled == (shared_ != nullptr)) {
+        return;
+    }
+    if (!enabled) {
+        flush_combined_();
+        shared_.reset();
+        return;
+    }
+    if (standby_enabled_ || writer_ || encoder_ || binary_ || index_every_bytes_ != 0 ||
+        recorder_) {
+        throw_spdlog_ex(
+            "rotating_dately_file_sink_new: multi-process mode cannot be combined with standby "
+            "file, async writer, stream encoder, binary format, time index or flight recorder");
+    }
+
+    /* 备份清单会被多个进程同时追加，改为轮转后扫描目录；维护任务可能正在使用清单 */
+    if (maintenance_) {
+        maintenance_->wait_idle();
+    }
+    manifest_.reset();
+    truncate_ = false;
+
+    flush_combined_();
+    file_helper_->flush();
+    shared_.reset(new details::shared_rotation(base_filename_ + SPDLOG_FILENAME_T(".ctl")));
+    {
+        details::shared_rotation_lock shared_lock(*shared_);
+        shared_->attach(get_file_size(base_filename_), backup_sequence_,
+                        schedule_.next_boundary(log_clock::now()));
+        if (shared_lock.recovered()) {
+            shared_->reset(get_file_size(base_filename_));
+        }
+    }
+    reopen_shared_();
+    current_size_ = static_cast<std::size_t>(shared_->size());
+    rotation_tp_ = shared_->rotation_time();
+    shared_seen_sequence_ = backup_sequence_;
+}
+
+/* 落盘已写入的记录，锁内只写出缓冲区，锁外等待组提交 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::sync() {
+    std::uint64_t seq;
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        seq = flush_to_os_();
+    }
+    if (seq != 0) {
+        commit_.wait(seq);
+    }
+}
+
+#ifdef SPDLOG_DATELY_METRICS
+template <typename Mutex>
+SPDLOG_INLINE details::sink_metrics_snapshot rotating_dately_file_sink<Mutex>::metrics() const {
+    details::sink_metrics_snapshot snapshot = metrics_.snapshot();
+    details::collect_lock_metrics(base_sink<Mutex>::mutex_, snapshot);
+    return snapshot;
+}
+#endif
+
 template <typename Mutex>
 SPDLOG_INLINE filename_t rotating_dately_file_sink<Mutex>::filename() {
     std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-    return file_helper_.filename();
+    /* 切换到待命文件后，其重命名可能尚未完成，因此返回逻辑文件名 */
+    return base_filename_;
 }
 
 template <typename Mutex>
 SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
-    auto time = msg.time;
-    bool should_rotate = time >= rotation_tp_;
+    log_record_(msg, nullptr);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::log_record_(const details::log_msg &msg,
+                                                                 const memory_buf_t *formatted) {
+    if (suppressor_) {
+        /* 在格式化之前判断，被抑制的记录只做一次哈希和查表 */
+        details::suppression_summary pending;
+        bool admitted = suppressor_->admit(msg, pending);
+        if (pending.count != 0) {
+            write_summary_(pending, msg);
+        }
+        write_idle_summaries_(msg.time, false);
+        if (!admitted) {
+            return;
+        }
+    }
+    write_record_(msg, formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_record_(
+    const details::log_msg &msg, const memory_buf_t *preformatted) {
+    if (binary_) {
+        write_binary_(msg);
+        return;
+    }
+    if (preformatted != nullptr && !own_formatter_) {
+        write_formatted_(msg.time, *preformatted);
+        return;
+    }
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
-    auto new_size = current_size_ + formatted.size();
+    write_formatted_(msg.time, formatted);
+}
 
-    if (new_size > max_size_ || should_rotate) {
-        rotate_();
-        new_size = formatted.size();
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_summary_(
+    const details::suppression_summary &summary, const details::log_msg &current) {
+    summary_buf_.clear();
+    details::log_suppressor::format_summary(summary, summary_buf_);
+    details::log_msg msg(current.time, summary.source,
+                         summary.current_key ? current.logger_name : string_view_t(),
+                         summary.level, string_view_t(summary_buf_.data(), summary_buf_.size()));
+    write_record_(msg, nullptr);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_idle_summaries_(
+    log_clock::time_point time, bool force) {
+    suppressor_->collect_idle(time, idle_summaries_, force);
+    if (idle_summaries_.empty()) {
+        return;
+    }
+    details::log_msg current(time, source_loc(), string_view_t(), level::info, string_view_t());
+    for (const auto &summary : idle_summaries_) {
+        write_summary_(summary, current);
+    }
+    idle_summaries_.clear();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_formatted_(
+    log_clock::time_point time, const memory_buf_t &formatted) {
+    SPDLOG_DATELY_METRICS_ONLY(auto write_start = details::sink_metrics::clock::now();)
+    if (shared_) {
+        sync_shared_();
+    }
+    if (standby_failed_.load(std::memory_order_acquire)) {
+        recover_standby_();
     }
 
-    file_helper_.write(formatted);
-    current_size_ = new_size;
+    /* 下一个边界在轮转前更新，多进程模式的轮转把它写入共享状态 */
+    bool should_rotate = time >= rotation_tp_;
+    if (should_rotate) {
+        rotation_tp_ = schedule_.next_boundary(time);
+    }
+
+    /* 先于文件写入记录到环形文件，写文件时崩溃也不会丢失这条记录 */
+    if (recorder_) {
+        recorder_->write(formatted.data(), formatted.size());
+    }
+
+    if (encoder_) {
+        /* 按已写出的编码后字节判断大小，轮转前结束当前帧 */
+        if (current_size_ >= max_size_ || should_rotate) {
+            end_frame_();
+            rotate_on_write_(should_rotate);
+        }
+        encoded_buf_.clear();
+        encoder_->encode(formatted.data(), formatted.size(), encoded_buf_);
+        write_bytes_(encoded_buf_);
+    } else {
+        if (current_size_ + formatted.size() > max_size_ || should_rotate) {
+            rotate_on_write_(should_rotate);
+        }
+        if (index_every_bytes_ != 0) {
+            index_record_(time);
+        }
+        write_bytes_(formatted);
+    }
+    apply_flush_policy_(time);
+    SPDLOG_DATELY_METRICS_ONLY(metrics_.add_record();
+                               metrics_.write_latency.record(details::sink_metrics::clock::now() -
+                                                             write_start);)
+}
 
+/* 先按当前文件的字符串定义编码，需要轮转时（新文件的定义已清空）重新编码 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_binary_(const details::log_msg &msg) {
+    SPDLOG_DATELY_METRICS_ONLY(auto write_start = details::sink_metrics::clock::now();)
+    if (standby_failed_.load(std::memory_order_acquire)) {
+        recover_standby_();
+    }
+    bool should_rotate = msg.time >= rotation_tp_;
     if (should_rotate) {
-        rotation_tp_ = next_rotation_tp_();
-        clean_old_files();
+        rotation_tp_ = schedule_.next_boundary(msg.time);
+    }
+
+    if (recorder_) {
+        recorder_buf_.clear();
+        base_sink<Mutex>::formatter_->format(msg, recorder_buf_);
+        recorder_->write(recorder_buf_.data(), recorder_buf_.size());
+    }
+
+    binary_buf_.clear();
+    if (current_size_ == 0) {
+        details::binary_record_encoder::write_header(binary_buf_);
+    }
+    binary_->encode(msg, binary_buf_);
+
+    if (current_size_ + binary_buf_.size() > max_size_ || should_rotate) {
+        rotate_on_write_(should_rotate);
+        binary_buf_.clear();
+        if (current_size_ == 0) {
+            details::binary_record_encoder::write_header(binary_buf_);
+        }
+        binary_->encode(msg, binary_buf_);
+    }
+    write_bytes_(binary_buf_);
+    apply_flush_policy_(msg.time);
+    SPDLOG_DATELY_METRICS_ONLY(metrics_.add_record();
+                               metrics_.write_latency.record(details::sink_metrics::clock::now() -
+                                                             write_start);)
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::rotate_on_write_(bool by_date) {
+    SPDLOG_DATELY_METRICS_ONLY(auto rotate_start = details::sink_metrics::clock::now();
+                               metrics_.add_rotation(by_date);)
+    flush_combined_();
+    rotate_();
+    SPDLOG_DATELY_METRICS_ONLY(
+        metrics_.add_rotate_time(details::sink_metrics::clock::now() - rotate_start);)
+    (void)by_date;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::rotate_by_date_(log_clock::time_point time) {
+    rotation_tp_ = schedule_.next_boundary(time);
+    if (current_size_ != 0) {
+        end_frame_();
+        rotate_on_write_(true);
     }
 }
 
 template <typename Mutex>
 SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::flush_() {
-    file_helper_.flush();
+    SPDLOG_DATELY_METRICS_ONLY(auto flush_start = details::sink_metrics::clock::now();)
+    if (suppressor_) {
+        write_idle_summaries_(log_clock::now(), false);
+    }
+    std::uint64_t seq = flush_to_os_();
+    if (seq != 0) {
+        commit_.wait(seq);
+    }
+    SPDLOG_DATELY_METRICS_ONLY(
+        metrics_.flush_latency.record(details::sink_metrics::clock::now() - flush_start);)
+}
+
+/* 写入文件（或合并缓冲区）并累计当前文件大小 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_bytes_(const memory_buf_t &buf) {
+    if (buf.size() == 0) {
+        return;
+    }
+    SPDLOG_DATELY_METRICS_ONLY(metrics_.add_bytes(buf.size());)
+    /* 先计入，异步写入丢弃时由write_file_()扣除 */
+    current_size_ += buf.size();
+    unflushed_bytes_ += buf.size();
+    if (combine_limit_ == 0) {
+        write_file_(buf);
+    } else {
+        combine_buf_.append(buf.data(), buf.data() + buf.size());
+        if (combine_buf_.size() >= combine_limit_) {
+            flush_combined_();
+        }
+    }
 }
 
 template <typename Mutex>
-SPDLOG_INLINE tm rotating_dately_file_sink<Mutex>::now_tm(log_clock::time_point tp) {
-    time_t tnow = log_clock::to_time_t(tp);
-    return spdlog::details::os::localtime(tnow);
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::write_file_(const memory_buf_t &buf) {
+    if (writer_) {
+        if (!writer_->write(buf.data(), buf.size())) {
+            /* 丢弃的数据没有写进文件，不计入当前文件大小 */
+            current_size_ -= std::min(current_size_, buf.size());
+            return;
+        }
+    } else if (shared_) {
+        shared_->write(buf.data(), buf.size());
+    } else if (direct_) {
+        direct_->write(buf.data(), buf.size());
+    } else {
+        file_helper_->write(buf);
+    }
+    /* 合并写入时数据在flush_combined_()中才到这里；回写的范围按文件的实际大小 */
+    if (tuner_) {
+        tuner_->written(buf.size());
+    }
 }
 
 template <typename Mutex>
-SPDLOG_INLINE log_clock::time_point rotating_dately_file_sink<Mutex>::next_rotation_tp_() {
-    auto now = log_clock::now();
-    tm date = now_tm(now);
-    date.tm_hour = 0;
-    date.tm_min = 0;
-    date.tm_sec = 0;
-    auto rotation_time = log_clock::from_time_t(std::mktime(&date));
-    if (rotation_time > now) {
-        return rotation_time;
+SPDLOG_INLINE std::uint64_t rotating_dately_file_sink<Mutex>::flush_to_os_() {
+    end_frame_();
+    flush_combined_();
+    file_helper_->flush();
+    if (writer_) {
+        writer_->drain();
+    }
+    unflushed_bytes_ = 0;
+    return sync_file_ ? commit_.mark() : 0;
+}
+
+/* 任一条件满足时flush；有维护线程时落盘交给维护线程，日志线程只写出到内核 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::apply_flush_policy_(
+    log_clock::time_point time) {
+    bool by_bytes =
+        flush_policy_.every_bytes != 0 && unflushed_bytes_ >= flush_policy_.every_bytes;
+    bool by_time =
+        flush_policy_.every.count() != 0 && time - last_flush_time_ >= flush_policy_.every;
+    if (!by_bytes && !by_time) {
+        return;
+    }
+    last_flush_time_ = time;
+
+    /* 异步写入时只把数据交给I/O线程，durable时等待写完后再取序号落盘 */
+    if (writer_) {
+        end_frame_();
+        flush_combined_();
+        unflushed_bytes_ = 0;
+        if (!sync_file_) {
+            return;
+        }
+        std::shared_ptr<details::async_file_writer> writer = writer_;
+        run_maintenance_([this, writer] {
+            writer->drain();
+            commit_.wait(commit_.mark());
+        });
+        return;
+    }
+
+    std::uint64_t seq = flush_to_os_();
+    if (seq == 0) {
+        return;
+    }
+    if (maintenance_) {
+        run_maintenance_([this, seq] { commit_.wait(seq); });
+    } else {
+        commit_.wait(seq);
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::open_sync_file_(const filename_t &filename) {
+    sync_file_ = std::make_shared<details::sync_file>(filename);
+    commit_.set_file(sync_file_);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::attach_file_handles_(
+    const filename_t &filename) {
+    if (sync_file_) {
+        open_sync_file_(filename);
+    }
+    if (tuner_) {
+        tuner_ = std::make_shared<details::file_tuner>(filename, preallocate_ ? max_size_ : 0,
+                                                       evict_window_);
+    }
+    if (writer_) {
+        writer_->open(filename);
+    }
+    if (direct_) {
+        direct_.reset(new details::append_file(filename));
     }
-    return {rotation_time + std::chrono::hours(24)};
+}
+
+/* 距上一个条目超过字节间隔或时间间隔（或是文件的第一条记录）时，记录当前偏移 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::index_record_(log_clock::time_point time) {
+    if (!index_.empty() && current_size_ - index_last_offset_ < index_every_bytes_ &&
+        time - index_last_time_ < index_interval_) {
+        return;
+    }
+    index_.push_back({details::time_index::to_index_time(time),
+                      static_cast<std::uint64_t>(current_size_)});
+    index_last_offset_ = current_size_;
+    index_last_time_ = time;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE std::shared_ptr<std::vector<details::time_index_entry>>
+rotating_dately_file_sink<Mutex>::take_index_() {
+    if (index_.empty()) {
+        return nullptr;
+    }
+    auto index = std::make_shared<std::vector<details::time_index_entry>>();
+    index->swap(index_);
+    return index;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::end_frame_() {
+    if (!encoder_) {
+        return;
+    }
+    encoded_buf_.clear();
+    encoder_->end_frame(encoded_buf_);
+    write_bytes_(encoded_buf_);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::flush_combined_() {
+    if (combine_buf_.size() == 0) {
+        return;
+    }
+    write_file_(combine_buf_);
+    combine_buf_.clear();
 }
 
 /* 计算备份文件名 */
 template <typename Mutex>
-SPDLOG_INLINE filename_t rotating_dately_file_sink<Mutex>::calc_backup_filename(const tm &tm_info) {
+SPDLOG_INLINE filename_t rotating_dately_file_sink<Mutex>::calc_backup_filename(
+    log_clock::time_point tp, std::uint64_t sequence) {
     filename_t full_dir = directory_;
     if (!full_dir.empty() && full_dir.back() != '/' && full_dir.back() != '\\') {
         full_dir += '/';
     }
 
-    /* 预期格式: "app_YYYYmmdd_HHMMSS.log" */
-    return fmt_lib::format(SPDLOG_FILENAME_T("{}app_{:04d}{:02d}{:02d}_{:02d}{:02d}{:02d}.log"),
-                           full_dir, tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
-                           tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+    /* 格式见details::backup_name（流式编码时追加后缀，如".log.zst"） */
+    return full_dir + naming_.format(tp, sequence, backup_suffix_);
 }
 
 /* 文件旋转逻辑 */
@@ -427,20 +1301,73 @@ template <typename Mutex>
 SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::rotate_() {
     using details::os::filename_to_str;
 
+    if (shared_) {
+        rotate_shared_();
+        return;
+    }
+    if (standby_failed_.load(std::memory_order_acquire)) {
+        recover_standby_();
+    }
+
+    /* 新文件重新定义二进制记录用到的字符串 */
+    if (binary_) {
+        binary_->reset();
+    }
+
+    /* 待命文件已就绪时只切换文件指针；上一次重命名尚未完成时先等待，
+       否则同步流程会在旧文件改名之前改名当前文件，备份的先后顺序被打乱；
+       等待后仍未就绪（如重命名失败）则走同步流程 */
+    if (standby_enabled_) {
+        std::unique_ptr<details::file_helper> standby = take_standby_();
+        if (!standby && maintenance_) {
+            maintenance_->wait_idle();
+            standby = take_standby_();
+        }
+        if (standby) {
+            rotate_to_standby_(std::move(standby));
+            return;
+        }
+    }
+
+    /* 启用维护线程时，旧文件的关闭（含缓冲区落盘）交给维护线程；
+       Windows下无法重命名已打开的文件，仍需先关闭 */
+#ifdef _WIN32
+    bool defer_close = false;
+#else
+    bool defer_close = maintenance_ != nullptr;
+#endif
+
     /* 关闭当前文件 */
-    file_helper_.close();
+    if (!defer_close) {
+        file_helper_->close();
+    }
+
+    /* durable时旧文件在改名前落盘 */
+    if (sync_file_) {
+        if (defer_close) {
+            file_helper_->flush();
+        }
+        if (writer_) {
+            writer_->drain();
+        }
+        commit_.wait(commit_.mark());
+    }
 
     /* 获取当前时间，用于生成备份文件名 */
     auto now = log_clock::now();
-    tm now_tm_info = now_tm(now);
-    filename_t backup_filename = calc_backup_filename(now_tm_info);
+    std::uint64_t sequence = ++backup_sequence_;
+    filename_t backup_filename = calc_backup_filename(now, sequence);
 
     /* 重命名当前文件为备份文件 */
+    bool renamed = false;
     if (file_exists(base_filename_)) {
-        if (!rename_file(base_filename_, backup_filename)) {
+        renamed = rename_file(base_filename_, backup_filename);
+        if (!renamed) {
             /* 重命名失败，尝试再次打开原文件继续写入 */
-            file_helper_.open(base_filename_, truncate_);
-            current_size_ = file_helper_.size();
+            if (!defer_close) {
+                file_helper_->open(base_filename_, truncate_);
+            }
+            current_size_ = file_helper_->size();
             throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
                                 filename_to_str(base_filename_) + " to " +
                                 filename_to_str(backup_filename),
@@ -448,96 +1375,406 @@ SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::rotate_() {
         }
     }
 
-    /* 打开新的日志文件（使用原始文件名） */
-    file_helper_.open(base_filename_, truncate_);
+    /* 打开新的日志文件（使用原始文件名），旧文件交给维护任务关闭 */
+    std::shared_ptr<details::file_helper> old_file;
+    if (defer_close) {
+        old_file = std::move(file_helper_);
+        file_helper_.reset(new details::file_helper(event_handlers_));
+    }
+    std::size_t backup_size = current_size_;
+    std::shared_ptr<details::file_tuner> old_tuner = tuner_;
+    std::shared_ptr<details::async_file_writer> writer = writer_;
+    file_helper_->open(base_filename_, truncate_);
     current_size_ = 0;
-
-    /* 将新的备份文件添加到队列 */
-    if (max_files_ > 0) {
-        if (filenames_q_.full()) {
-            filenames_q_.pop_front();
+    attach_file_handles_(base_filename_);
+
+    /* 将新的备份文件登记到备份目录，并按数量/时间清理（只处理被删除的文件） */
+    std::time_t backup_time = log_clock::to_time_t(now);
+    retention_policy policy = retention_();
+    std::shared_ptr<details::backup_processor> processor = processor_;
+    std::shared_ptr<std::vector<details::time_index_entry>> index = take_index_();
+    run_maintenance_([this, old_file, old_tuner, writer, backup_filename, backup_time,
+                      backup_size, sequence, renamed, processor, policy, index] {
+        /* 异步写入时先等旧文件的数据写完 */
+        if (writer) {
+            writer->drain();
         }
-        /* 使用拷贝而非移动语义，避免rvalue引用错误 */
-        filenames_q_.push_back(std::move(backup_filename));
+        if (old_file) {
+            old_file->close();
+        }
+        if (old_tuner) {
+            old_tuner->release_space();
+            old_tuner->evict_all();
+        }
+        if (renamed) {
+            if (index) {
+                details::time_index::write(details::time_index::sidecar_filename(backup_filename),
+                                           *index);
+            }
+            add_backup_({backup_filename, backup_time, backup_size, sequence});
+            if (processor) {
+                process_backup_(processor, backup_filename);
+            }
+        }
+        remove_expired_backups_(policy);
+    });
+}
+
+/* 按共享状态更新大小和日期轮转时间，其他进程已轮转时先重新打开当前文件 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::sync_shared_() {
+    if (shared_->generation() != shared_generation_) {
+        reopen_shared_();
     }
+    current_size_ = static_cast<std::size_t>(shared_->size());
+    rotation_tp_ = shared_->rotation_time();
 }
 
-/* 初始化文件名队列 */
+/* 先取代数再打开：打开之后发生的轮转会在下一次写入时发现，不会一直写到已改名的文件 */
 template <typename Mutex>
-SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::init_filenames_q_() {
-    filenames_q_ = details::circular_q<filename_t>(static_cast<size_t>(max_files_));
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::reopen_shared_() {
+    flush_combined_();
+    shared_generation_ = shared_->generation();
+    file_helper_->close();
+    file_helper_->open(base_filename_, false);
+    shared_->open_file(base_filename_);
+    attach_file_handles_(base_filename_);
+}
+
+/* 多进程轮转：持有进程间锁完成改名和打开新文件，代数未变才轮转（否则其他进程已轮转）；
+   上次轮转之后其他进程产生的备份从控制文件的轮转记录中登记，再按保留策略清理 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::rotate_shared_() {
+    using details::os::filename_to_str;
+    details::shared_rotation_lock shared_lock(*shared_);
 
-    if (directory_.empty()) {
+    /* 上一个持锁进程在轮转中途退出：以实际文件为准，所有进程重新打开 */
+    if (shared_lock.recovered()) {
+        shared_->reset(get_file_size(base_filename_));
+    }
+    if (shared_->generation() != shared_generation_) {
+        reopen_shared_();
+        current_size_ = static_cast<std::size_t>(shared_->size());
         return;
     }
 
-    /* 使用平台兼容的目录遍历方法 */
-    std::vector<filename_t> backup_files;
+    file_helper_->close();
+    if (sync_file_) {
+        commit_.wait(commit_.mark());
+    }
 
-#ifdef _WIN32
-    /* Windows平台 */
-    WIN32_FIND_DATAA find_data;
-    HANDLE hFind = FindFirstFileA((directory_ + "\\app_*.log").c_str(), &find_data);
+    auto now = log_clock::now();
+    std::uint64_t sequence = shared_->next_sequence();
+    backup_sequence_ = sequence;
+    filename_t backup_filename = calc_backup_filename(now, sequence);
+    auto missed = std::make_shared<std::vector<details::backup_file>>();
+    bool complete = shared_->read_backups(shared_seen_sequence_, sequence, *missed);
+    shared_seen_sequence_ = sequence;
+    bool renamed = false;
+    if (file_exists(base_filename_)) {
+        renamed = rename_file(base_filename_, backup_filename);
+        if (!renamed) {
+            file_helper_->open(base_filename_, false);
+            throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
+                                filename_to_str(base_filename_) + " to " +
+                                filename_to_str(backup_filename),
+                            errno);
+        }
+    }
 
-    if (hFind != INVALID_HANDLE_VALUE) {
-        do {
-            if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                backup_files.push_back(directory_ + "\\" + find_data.cFileName);
-            }
-        } while (FindNextFileA(hFind, &find_data) != 0);
+    details::backup_file backup{backup_filename, log_clock::to_time_t(now), current_size_,
+                                sequence};
+    shared_->record_backup({extract_filename(backup_filename), backup.time, backup.size, sequence});
+    std::shared_ptr<details::file_tuner> old_tuner = tuner_;
+    file_helper_->open(base_filename_, false);
+    shared_->open_file(base_filename_);
+    current_size_ = 0;
+    attach_file_handles_(base_filename_);
+    shared_->rotated(rotation_tp_);
+    shared_generation_ = shared_->generation();
+
+    retention_policy policy = retention_();
+    std::shared_ptr<details::backup_processor> processor = processor_;
+    run_maintenance_([this, old_tuner, missed, complete, backup, renamed, processor, policy] {
+        if (old_tuner) {
+            old_tuner->release_space();
+            old_tuner->evict_all();
+        }
 
-        FindClose(hFind);
-    }
-#else
-    /* POSIX平台 */
-    DIR *dir = opendir(directory_.c_str());
-    if (dir) {
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != nullptr) {
-            if (strncmp(entry->d_name, "app_", 4) == 0 &&
-                strstr(entry->d_name, ".log") != nullptr) {
-                backup_files.push_back(directory_ + "/" + entry->d_name);
+        /* 轮转记录不完整或备份已被改名（如其他进程压缩）时扫描目录，扫描结果已包含本次的备份 */
+        bool rescan = !complete;
+        for (auto &file : *missed) {
+            if (!directory_.empty()) {
+                file.filename = directory_ + SPDLOG_FILENAME_T("/") + file.filename;
+            }
+            if (!rescan && !file_exists(file.filename)) {
+                rescan = true;
             }
         }
-        closedir(dir);
+        if (rescan) {
+            std::size_t reused = 0;
+            std::vector<details::backup_file> entries = scan_backup_files_({}, reused);
+            std::sort(entries.begin(), entries.end(), details::backup_older);
+            backups_.clear();
+            for (auto &entry : entries) {
+                backups_.add(std::move(entry));
+            }
+        } else {
+            for (auto &file : *missed) {
+                add_backup_(std::move(file));
+            }
+            if (renamed) {
+                add_backup_(backup);
+            }
+        }
+        if (renamed && processor) {
+            process_backup_(processor, backup.filename);
+        }
+        remove_expired_backups_(policy);
+    });
+}
+
+/* 切换到待命文件：日志线程只交换文件指针，关闭、重命名和准备下一个待命文件由维护任务完成 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::rotate_to_standby_(
+    std::unique_ptr<details::file_helper> standby) {
+    using details::os::filename_to_str;
+
+    /* durable时旧文件先写出到内核，由维护任务在改名前落盘；在此之前请求的sync()会一并同步旧文件 */
+    std::shared_ptr<details::sync_file> old_sync = sync_file_;
+    if (old_sync) {
+        file_helper_->flush();
     }
-#endif
 
-    /* 按时间排序（最新的文件在前） */
-    std::sort(backup_files.begin(), backup_files.end(),
-              [this](const filename_t &a, const filename_t &b) {
-                  return extract_time_from_filename(a) > extract_time_from_filename(b);
-              });
+    std::size_t backup_size = current_size_;
+    std::shared_ptr<details::file_tuner> old_tuner = tuner_;
+    std::shared_ptr<details::async_file_writer> writer = writer_;
+    std::shared_ptr<details::file_helper> old_file(std::move(file_helper_));
+    file_helper_ = std::move(standby);
+    current_size_ = file_helper_->size();
+    attach_file_handles_(file_helper_->filename());
 
-    /* 添加到队列（保留最新的max_files_个文件） */
-    for (const auto &file : backup_files) {
-        if (filenames_q_.size() >= max_files_) {
-            break;
+    /* 备份名在日志线程确定，序号和编码后缀与轮转时一致 */
+    auto now = log_clock::now();
+    std::uint64_t sequence = ++backup_sequence_;
+    filename_t backup_filename = calc_backup_filename(now, sequence);
+    filename_t base_filename = base_filename_;
+    filename_t standby_filename = file_helper_->filename();
+    retention_policy policy = retention_();
+    std::shared_ptr<details::backup_processor> processor = processor_;
+    std::shared_ptr<std::vector<details::time_index_entry>> index = take_index_();
+    run_maintenance_([this, old_file, old_sync, old_tuner, writer, now, sequence, backup_filename,
+                      base_filename, standby_filename, backup_size, processor, policy, index] {
+        if (writer) {
+            writer->drain();
+        }
+        old_file->close();
+        if (old_sync) {
+            old_sync->sync();
+        }
+        if (old_tuner) {
+            old_tuner->release_space();
+            old_tuner->evict_all();
+        }
+
+        /* 旧文件改名为备份，待命文件改名为当前文件 */
+        if (file_exists(base_filename) && !rename_file(base_filename, backup_filename)) {
+            /* 不能再覆盖原文件名，也不再准备新的待命文件，日志线程下一次写入时退回当前文件 */
+            standby_failed_.store(true, std::memory_order_release);
+            throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
+                                filename_to_str(base_filename) + " to " +
+                                filename_to_str(backup_filename),
+                            errno);
         }
-        std::basic_string<char> theFile = file;
-        filenames_q_.push_back(std::move(theFile));
+        if (index) {
+            details::time_index::write(details::time_index::sidecar_filename(backup_filename),
+                                       *index);
+        }
+        add_backup_({backup_filename, log_clock::to_time_t(now), backup_size, sequence});
+        if (processor) {
+            process_backup_(processor, backup_filename);
+        }
+
+        if (!rename_file(standby_filename, base_filename)) {
+            standby_failed_.store(true, std::memory_order_release);
+            throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
+                                filename_to_str(standby_filename) + " to " +
+                                filename_to_str(base_filename),
+                            errno);
+        }
+
+        prepare_standby_(standby_filename);
+        remove_expired_backups_(policy);
+    });
+}
+
+/* 打开待命文件并截断（遗留的内容已由set_standby_file或recover_standby_保留为备份） */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::prepare_standby_(
+    const filename_t &standby_filename) {
+    std::unique_ptr<details::file_helper> standby(new details::file_helper(event_handlers_));
+    standby->open(standby_filename, true);
+
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    standby_ = std::move(standby);
+}
+
+/* 日志线程仍写在待命文件上：结束并关闭它，改名为备份后重新打开当前文件，再准备新的待命文件；
+   待命文件无法改名时保留原样（不再准备待命文件，避免截断），报告错误 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::recover_standby_() {
+    standby_failed_.store(false, std::memory_order_relaxed);
+    filename_t standby_filename = file_helper_->filename();
+
+    end_frame_();
+    flush_combined_();
+    if (writer_) {
+        writer_->drain();
+    }
+    if (tuner_) {
+        tuner_->release_space();
+    }
+    std::size_t standby_size = current_size_;
+    file_helper_->close();
+    bool salvaged = standby_size == 0 || salvage_standby_(standby_filename, standby_size);
+    int error = errno;
+    take_index_();
+    if (binary_) {
+        binary_->reset();
     }
+
+    file_helper_->open(base_filename_, false);
+    current_size_ = file_helper_->size();
+    attach_file_handles_(base_filename_);
+    if (!salvaged) {
+        throw_spdlog_ex("rotating_dately_file_sink_new: failed renaming " +
+                            details::os::filename_to_str(standby_filename),
+                        error);
+    }
+    run_maintenance_([this, standby_filename] { prepare_standby_(standby_filename); });
 }
 
-/* 清理旧文件 */
 template <typename Mutex>
-SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::clean_old_files() {
-    if (directory_.empty()) {
+SPDLOG_INLINE bool rotating_dately_file_sink<Mutex>::salvage_standby_(
+    const filename_t &standby_filename, std::size_t size) {
+    auto now = log_clock::now();
+    std::uint64_t sequence = ++backup_sequence_;
+    filename_t backup_filename = calc_backup_filename(now, sequence);
+    if (!rename_file(standby_filename, backup_filename)) {
+        return false;
+    }
+    std::time_t backup_time = log_clock::to_time_t(now);
+    retention_policy policy = retention_();
+    run_maintenance_([this, backup_filename, backup_time, size, sequence, policy] {
+        add_backup_({backup_filename, backup_time, size, sequence});
+        remove_expired_backups_(policy);
+    });
+    return true;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE std::unique_ptr<details::file_helper>
+rotating_dately_file_sink<Mutex>::take_standby_() {
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    return std::move(standby_);
+}
+
+/* 丢弃待命文件，未写入内容的删除掉 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::drop_standby_() {
+    std::unique_ptr<details::file_helper> standby = take_standby_();
+    if (!standby) {
+        return;
+    }
+    filename_t standby_filename = standby->filename();
+    bool empty = standby->size() == 0;
+    standby->close();
+    if (empty) {
+        remove(standby_filename.c_str());
+    }
+}
+
+/* 提交备份的后处理，完成后回到sink锁下（或维护线程上）更新备份目录 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::process_backup_(
+    const std::shared_ptr<details::backup_processor> &processor,
+    const filename_t &backup_filename) {
+    processor->process(backup_filename, [this, backup_filename](const filename_t &result_filename,
+                                                                std::size_t result_size) {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        run_maintenance_([this, backup_filename, result_filename, result_size] {
+            replace_backup_(backup_filename, result_filename, result_size);
+        });
+    });
+}
+
+/* 用后处理结果替换备份目录中的条目；原备份在处理期间已被清理时删除处理结果 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::replace_backup_(
+    const filename_t &backup_filename,
+    const filename_t &result_filename,
+    std::size_t result_size) {
+    if (!backups_.replace(backup_filename, result_filename, result_size)) {
+        remove(result_filename.c_str());
         return;
     }
+    if (manifest_) {
+        manifest_->append_remove(backup_filename);
+        manifest_->append_add(*backups_.find(result_filename));
+    }
+}
+
+/* 执行维护任务：启用维护线程时异步执行，否则在当前线程执行 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::run_maintenance_(std::function<void()> task) {
+    if (maintenance_) {
+        maintenance_->post(std::move(task));
+    } else {
+        task();
+    }
+}
 
-    /* 收集所有备份文件 */
-    std::vector<filename_t> backup_files;
+/* 扫描目录中的全部备份文件 */
+template <typename Mutex>
+SPDLOG_INLINE std::vector<details::backup_file>
+rotating_dately_file_sink<Mutex>::scan_backup_files_(std::vector<details::backup_file> known,
+                                                     std::size_t &reused) {
+    std::vector<details::backup_file> backup_files;
+    std::unordered_map<filename_t, std::size_t> known_names;
+    for (std::size_t i = 0; i < known.size(); ++i) {
+        known_names.emplace(extract_filename(known[i].filename), i);
+    }
+    reused = 0;
+
+    /* 每个文件只解析一次文件名、stat一次大小；跳过未完成的压缩临时文件和时间索引 */
+    auto add_file = [&](const filename_t &name, const filename_t &path) {
+        auto it = known_names.find(name);
+        if (it != known_names.end()) {
+            backup_files.push_back(std::move(known[it->second]));
+            ++reused;
+            return;
+        }
+        details::backup_stamp stamp;
+        std::size_t suffix_pos;
+        std::size_t len = name.size();
+        if (!naming_.parse(name, stamp, suffix_pos) ||
+            (len - suffix_pos >= 4 && (name.compare(len - 4, 4, ".tmp") == 0 ||
+                                       name.compare(len - 4, 4, ".idx") == 0))) {
+            return;
+        }
+        backup_files.push_back({path, stamp.time, get_file_size(path), stamp.sequence});
+    };
 
 #ifdef _WIN32
     /* Windows平台 */
     WIN32_FIND_DATAA find_data;
-    HANDLE hFind = FindFirstFileA((directory_ + "\\app_*.log").c_str(), &find_data);
+    HANDLE hFind =
+        FindFirstFileA((directory_ + "\\" + naming_.prefix() + "*.log*").c_str(), &find_data);
 
     if (hFind != INVALID_HANDLE_VALUE) {
         do {
             if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                backup_files.push_back(directory_ + "\\" + find_data.cFileName);
+                add_file(find_data.cFileName, directory_ + "\\" + find_data.cFileName);
             }
         } while (FindNextFileA(hFind, &find_data) != 0);
 
@@ -549,40 +1786,153 @@ SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::clean_old_files() {
     if (dir) {
         struct dirent *entry;
         while ((entry = readdir(dir)) != nullptr) {
-            if (strncmp(entry->d_name, "app_", 4) == 0 &&
-                strstr(entry->d_name, ".log") != nullptr) {
-                backup_files.push_back(directory_ + "/" + entry->d_name);
-            }
+            add_file(entry->d_name, directory_ + "/" + entry->d_name);
         }
         closedir(dir);
     }
 #endif
 
-    /* 根据修改时间排序（最旧的文件在前） */
-    std::sort(backup_files.begin(), backup_files.end(),
-              [this](const filename_t &a, const filename_t &b) {
-                  return extract_time_from_filename(a) < extract_time_from_filename(b);
-              });
-
-    /* 删除超出数量限制的旧文件 */
-    if (max_files_ != 0) {
-        if (backup_files.size() > max_files_) {
-            size_t files_to_delete = backup_files.size() - max_files_;
-            for (size_t i = 0; i < files_to_delete; ++i) {
-                remove(backup_files[i].c_str());
+    return backup_files;
+}
+
+/* 初始化备份目录：优先一次读入备份清单（不列目录，之后由reconcile_backup_catalog_()核对），
+   清单缺失或损坏时扫描一次目录并重建清单，每个文件名只解析一次 */
+template <typename Mutex>
+SPDLOG_INLINE bool rotating_dately_file_sink<Mutex>::init_backup_catalog_() {
+    backups_.clear();
+    catalog_loaded_at_ = std::time(nullptr);
+
+    std::vector<details::backup_file> entries;
+    bool loaded = manifest_ && manifest_->load(entries);
+    if (loaded) {
+        /* 清单不记录轮转序号，从文件名中解析 */
+        for (auto &entry : entries) {
+            details::backup_stamp stamp;
+            std::size_t suffix_pos;
+            if (naming_.parse(extract_filename(entry.filename), stamp, suffix_pos)) {
+                entry.sequence = stamp.sequence;
             }
         }
+    } else if (!directory_.empty()) {
+        std::size_t reused = 0;
+        entries = scan_backup_files_({}, reused);
+    }
+
+    /* 按预先解析的时间和序号排序（最旧的文件在前），新备份的序号接在已有备份之后 */
+    std::sort(entries.begin(), entries.end(), details::backup_older);
+    for (auto &entry : entries) {
+        backup_sequence_ = std::max(backup_sequence_, entry.sequence);
+        backups_.add(std::move(entry));
+    }
+
+    /* 清单缺失或损坏，用扫描结果重建 */
+    if (manifest_ && !loaded) {
+        manifest_->rewrite(backups_.files());
     }
+    return loaded && !directory_.empty();
+}
 
-    /* 删除超过保留时间的旧文件 */
+/* 清单与目录核对（只列目录，清单中的文件不再stat）：轮转改名后、追加清单前崩溃留下的备份
+   补充登记，已不存在的条目去掉，不一致时重写清单
+   构造之后产生的备份由本进程登记（可能已改名但登记任务还在队列中，或正在压缩），不参与核对 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::reconcile_backup_catalog_() {
+    if (!catalog_unverified_) {
+        return;
+    }
+    catalog_unverified_ = false;
+    if (!manifest_) {
+        return;
+    }
+
+    std::vector<details::backup_file> known, recent;
+    for (const auto &file : backups_.files()) {
+        (file.time < catalog_loaded_at_ ? known : recent).push_back(file);
+    }
+    std::size_t listed = known.size();
+    std::size_t reused = 0;
+    std::vector<details::backup_file> entries = scan_backup_files_(std::move(known), reused);
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [this](const details::backup_file &file) {
+                                     return file.time >= catalog_loaded_at_;
+                                 }),
+                  entries.end());
+    if (reused == listed && entries.size() == listed) {
+        return;
+    }
+
+    for (auto &file : recent) {
+        entries.push_back(std::move(file));
+    }
+    std::sort(entries.begin(), entries.end(), details::backup_older);
+    backups_.clear();
+    for (auto &entry : entries) {
+        backups_.add(std::move(entry));
+    }
+    manifest_->rewrite(backups_.files());
+}
+
+/* 登记新的备份文件，同时追加到备份清单 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::add_backup_(details::backup_file file) {
+    if (manifest_) {
+        manifest_->append_add(file);
+    }
+    backups_.add(std::move(file));
+}
+
+/* 清理旧文件（按当前的数量/时间/总大小限制） */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::clean_old_files() {
+    retention_policy policy = retention_();
+    run_maintenance_([this, policy] { remove_expired_backups_(policy); });
+}
+
+/* 当前的清理条件 */
+template <typename Mutex>
+SPDLOG_INLINE typename rotating_dately_file_sink<Mutex>::retention_policy
+rotating_dately_file_sink<Mutex>::retention_() const {
+    return retention_policy{max_files_, max_age_, max_total_size_};
+}
+
+/* 删除过期备份：从备份目录的最旧一端弹出，复杂度与删除的文件数成正比 */
+template <typename Mutex>
+SPDLOG_INLINE void rotating_dately_file_sink<Mutex>::remove_expired_backups_(
+    const retention_policy &policy) {
+    SPDLOG_DATELY_METRICS_ONLY(auto clean_start = details::sink_metrics::clock::now();
+                               std::size_t deleted = 0;)
+    reconcile_backup_catalog_();
     auto now = std::time(nullptr);
-    auto max_age_seconds = std::chrono::duration_cast<std::chrono::seconds>(max_age_).count();
-    for (const auto &file : backup_files) {
-        auto file_time = extract_time_from_filename(file);
-        if (now - file_time > max_age_seconds) {
-            remove(file.c_str());
+    auto max_age_seconds =
+        std::chrono::duration_cast<std::chrono::seconds>(policy.max_age).count();
+
+    while (!backups_.empty()) {
+        const details::backup_file &oldest = backups_.oldest();
+
+        /* 超出数量限制、超过保留时间或超出总大小 */
+        bool over_count = policy.max_files != 0 && backups_.size() > policy.max_files;
+        bool expired = now - oldest.time > max_age_seconds;
+        bool over_budget =
+            policy.max_total_size != 0 && backups_.total_size() > policy.max_total_size;
+        if (!over_count && !expired && !over_budget) {
+            break;
         }
+
+        remove(oldest.filename.c_str());
+        remove(details::time_index::sidecar_filename(oldest.filename).c_str());
+        SPDLOG_DATELY_METRICS_ONLY(++deleted;)
+        if (manifest_) {
+            manifest_->append_remove(oldest.filename);
+        }
+        backups_.pop_oldest();
+    }
+
+    if (manifest_ && manifest_->needs_compaction(backups_.size())) {
+        manifest_->rewrite(backups_.files());
     }
+    SPDLOG_DATELY_METRICS_ONLY(
+        metrics_.add_files_deleted(deleted);
+        metrics_.add_clean_time(details::sink_metrics::clock::now() - clean_start);)
 }
 
 }  // namespace sinks
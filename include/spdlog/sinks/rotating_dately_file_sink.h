@@ -2,10 +2,31 @@
 
 #include "spdlog/sinks/base_sink.h"
 #include "spdlog/details/file_helper.h"
-#include "spdlog/details/circular_q.h"
+#include "spdlog/details/append_file.h"
+#include "spdlog/details/async_file_writer.h"
+#include "spdlog/details/backup_catalog.h"
+#include "spdlog/details/backup_manifest.h"
+#include "spdlog/details/backup_name.h"
+#include "spdlog/details/backup_processor.h"
+#include "spdlog/details/binary_record.h"
+#include "spdlog/details/compiled_pattern.h"
+#include "spdlog/details/file_tuner.h"
+#include "spdlog/details/flight_recorder.h"
+#include "spdlog/details/flush_policy.h"
+#include "spdlog/details/log_suppressor.h"
+#include "spdlog/details/rotation_schedule.h"
+#include "spdlog/details/stream_encoder.h"
+#include "spdlog/details/time_index.h"
+#include "spdlog/details/maintenance_worker.h"
+#include "spdlog/details/shared_rotation.h"
+#include "spdlog/details/sink_metrics.h"
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <ctime>
+#include <vector>
 
 /* 平台兼容性头文件 */
 #ifdef _WIN32
@@ -20,6 +41,10 @@
 namespace spdlog {
 namespace sinks {
 
+class preformat_dately_file_sink;
+class combining_dately_file_sink;
+class routing_dately_file_sink;
+
 template <typename Mutex>
 class rotating_dately_file_sink final : public base_sink<Mutex> {
 public:
@@ -29,29 +54,197 @@ public:
                                                               10, /* 默认最大文件大小 10MB */
                                        std::size_t max_files = 0,
                                        bool truncate = false,
-                                       const file_event_handlers &event_handlers = {});
+                                       const file_event_handlers &event_handlers = {},
+                                       bool use_manifest = false, /* 用备份清单加快启动 */
+                                       /* 备份文件名前缀，见details::backup_name */
+                                       const filename_t &backup_prefix = SPDLOG_FILENAME_T("app_"));
+    ~rotating_dately_file_sink() override;
 
     void set_max_date(std::chrono::hours max_age);
     void set_max_size(std::size_t max_size);
     void set_max_files(std::size_t max_files);
+    void set_max_total_size(std::size_t max_total_size); /* 备份总大小上限，0表示不限制 */
+    /* 按日期轮转的周期（默认每天本地时间0点），如details::rotation_schedule::hourly()；
+       是否轮转按记录时间判断，下一个边界也从触发轮转的记录时间算起；多进程模式下需在
+       set_multi_process之前设置，各进程使用相同的周期 */
+    void set_rotation_schedule(const details::rotation_schedule &schedule);
     void set_dately_file_pattern(const std::string &pattern);  /* 设置日志格式 */
-    void set_current_filename(const filename_t &new_filename); /* 修改当前日志文件名 */
+    /* 修改当前日志文件名（当前文件随之改名）；多进程模式下抛出异常 */
+    void set_current_filename(const filename_t &new_filename);
+
+#ifdef SPDLOG_DATELY_STATIC_PATTERN
+    /* C++20：pattern在编译期解析（details::static_pattern_formatter），格式化时不经过虚调用，
+       日期时间按秒、毫秒缓存；pattern不受支持时等同于set_dately_file_pattern(pattern) */
+    template <details::pattern_string Pattern>
+    void set_dately_file_pattern();
+#endif
+
+    /* 设置后台维护线程（可多个sink共享），传入nullptr则恢复在日志线程中同步维护 */
+    void set_maintenance_worker(std::shared_ptr<details::maintenance_worker> worker);
+    void wait_for_maintenance(); /* 等待已提交的维护任务全部完成 */
+
+    /* 预先打开下一个日志文件（"<base>.next"），按大小轮转时只需切换文件指针，
+       重命名由维护任务完成（仅POSIX，Windows下无法重命名已打开的文件） */
+    void set_standby_file(bool enabled);
+
+    /* 合并写：记录先追加到内存缓冲区，攒满（向上取整到文件系统块大小）或flush时经
+       details::append_file一次write写出（不经过stdio），轮转前先写出缓冲区，记录不会跨文件拆分；
+       传入0关闭 */
+    void set_write_combining(std::size_t buffer_size);
+
+    /* 轮转后处理（如details::backup_compressor），处理结果会替换备份目录中的原文件；
+       处理在后台线程完成后通过sink锁更新备份目录，因此需配合_mt sink使用；
+       替换（或传入nullptr取消）时等待旧处理器上本sink的任务完成后返回 */
+    void set_backup_processor(std::shared_ptr<details::backup_processor> processor);
+
+    /* 流式编码输出（如details::compressed_stream_encoder）：max_size按写出的编码后字节计算，
+       文件最多超出一帧；flush和轮转前结束当前帧，备份文件名追加编码器的后缀；
+       当前文件非空时先轮转，保证每个文件只有一种格式；传入nullptr恢复明文输出 */
+    void set_stream_encoder(std::unique_ptr<details::stream_encoder> encoder);
+
+    /* 稀疏时间索引：每写出every_bytes字节或每隔interval记录一个（时间，偏移）条目，
+       轮转时写到备份旁的 "<备份>.idx"，当前文件的索引在sink关闭时写出；
+       用details::time_index_reader按时间段查询；流式编码输出不建索引；every_bytes传入0关闭 */
+    void set_time_index(std::size_t every_bytes,
+                        std::chrono::milliseconds interval = std::chrono::seconds(1));
+
+    /* 二进制记录模式：不做pattern格式化，直接写出时间、级别、logger、源码位置和消息内容，
+       字符串在每个文件中只定义一次；用details::binary_record_decoder按任意pattern还原文本；
+       消息参数在logger中已经格式化，这里省去的只是pattern部分，整体吞吐量只提升一到两成，
+       主要收益是写入字节数减少（默认pattern下约三分之一）；
+       备份文件名追加".bin"；当前文件非空时先轮转；与流式编码互斥，不建立时间索引；
+       由preformat/combining包装sink持有时抛出异常（它们在锁外格式化文本） */
+    void set_binary_format(bool enabled);
+
+    /* flush策略：写入时按字节数/记录时间间隔flush；durable时flush后fdatasync，轮转时旧文件改名前落盘；
+       启用维护线程时按策略触发的落盘在维护线程上进行，显式flush()仍在返回前落盘 */
+    void set_flush_policy(const details::flush_policy &policy);
+
+    /* 把已写入的记录交给内核（durable时并落盘）后返回；等待落盘时不持有sink锁，
+       并发调用的线程共享一次fdatasync（组提交），适合审计日志按需确认 */
+    void sync();
+
+    /* Linux下的文件空间和页缓存管理（其他平台上不做任何事）：preallocate时按max_size为当前文件
+       预分配空间（不改变文件大小，轮转和关闭时释放未用完的部分）；evict_window非0时每写出一个窗口
+       启动回写并把上一个窗口移出页缓存，轮转后的备份由维护任务整体移出，避免日志挤占页缓存 */
+    void set_file_tuning(bool preallocate, std::size_t evict_window = 0);
+
+    /* 异步写入（details::async_file_writer）：日志线程只把数据复制到buffer_count个缓冲区之一，
+       由专用I/O线程写文件（定义SPDLOG_DATELY_IO_URING时经io_uring提交），磁盘卡顿不阻塞日志线程；
+       缓冲区全部在途时阻塞，或在drop_on_overflow时丢弃整条记录（不计入文件大小）；
+       flush()等待已提交的数据写完；drop_on_overflow不能与流式编码或二进制格式同时使用；
+       需要先设置set_maintenance_worker和set_standby_file，轮转时的重命名/打开/删除由维护线程完成，
+       启用期间不能取消这两项（Windows下没有待命文件，轮转仍在日志线程中进行）；
+       buffer_size传入0恢复同步写入 */
+    void set_async_writer(std::size_t buffer_size,
+                          std::size_t buffer_count = 8,
+                          bool drop_on_overflow = false);
+
+    /* 飞行记录器（details::flight_recorder）：每条记录的文本再复制一份到内存映射的环形文件
+       "<base>.ring"（容量capacity字节），只做内存拷贝；进程崩溃（包括SIGKILL）时仍留在stdio或
+       合并缓冲区中的记录可用details::flight_recorder::recover()取回，因而主文件可用大缓冲、少flush；
+       不能防止掉电丢失；二进制模式下额外按pattern格式化一次；set_current_filename时环形文件随之改名；
+       capacity传入0关闭 */
+    void set_flight_recorder(std::size_t capacity);
+
+    /* 重复抑制（details::log_suppressor）：同一调用点、logger、级别和内容的记录每interval最多写出
+       burst条，其余只计数，在格式化之前丢弃；计数以同级别的 "suppressed N similar messages" 记录
+       写出（每个键每interval最多一条；该键空闲后在后续写入或flush时补写，析构时写出剩余计数）；
+       routing包装的每个输出各自生效；由preformat/combining包装sink持有时抛出异常（记录不经过
+       sink_it_，在锁外已格式化）；burst传入0关闭 */
+    void set_suppression(const details::suppression_policy &policy);
+
+    /* 多进程模式：多个进程的sink写同一个base_filename时使用（details::shared_rotation，仅POSIX）；
+       记录以O_APPEND整条写入，大小、轮转代数和日期轮转时间保存在共享控制文件"<base>.ctl"中，
+       只有一个进程执行轮转（持有进程间锁），其他进程在下一次写入时发现代数变化后重新打开文件；
+       执行轮转的进程从控制文件的轮转记录中登记其他进程产生的备份后按保留策略清理；
+       不使用备份清单，不截断已有文件；每条记录一次write，可用合并写减少系统调用（文件最多超出
+       一个合并缓冲区）；与待命文件、异步写入、流式编码、二进制模式、时间索引和飞行记录器互斥，
+       启用后不能再修改当前文件名 */
+    void set_multi_process(bool enabled);
 
     filename_t filename();
 
+#ifdef SPDLOG_DATELY_METRICS
+    /* 运行指标快照，可在任意线程调用；锁等待/持有时间需使用details::metered_mutex */
+    details::sink_metrics_snapshot metrics() const;
+#endif
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
     void flush_() override;
+    void set_pattern_(const std::string &pattern) override;
+    void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter) override;
 
 private:
+    friend class preformat_dately_file_sink;
+    friend class combining_dately_file_sink;
+    friend class routing_dately_file_sink;
+
     static constexpr size_t MaxFiles = 200000;
 
-    tm now_tm(log_clock::time_point tp);
-    log_clock::time_point next_rotation_tp_();
-    filename_t calc_backup_filename(const tm &tm_info);
-    void init_filenames_q_();
+    /* 写入已格式化的记录，只做轮转判断和追加（调用方持有锁） */
+    void write_formatted_(log_clock::time_point time, const memory_buf_t &formatted);
+    void flush_combined_(); /* 写出合并缓冲区 */
+    void write_bytes_(const memory_buf_t &buf);
+    void write_file_(const memory_buf_t &buf); /* 写到文件或交给异步写入 */
+    /* 写出全部缓冲区到内核，durable时返回用于等待落盘的组提交序号，否则返回0 */
+    std::uint64_t flush_to_os_();
+    void apply_flush_policy_(log_clock::time_point time); /* 写入后按策略flush */
+    void open_sync_file_(const filename_t &filename);
+    void attach_file_handles_(const filename_t &filename); /* 为新的当前文件打开辅助句柄 */
+    void rotate_on_write_(bool by_date); /* 写入前的轮转：写出合并缓冲区后轮转 */
+    /* 日期轮转（当前文件为空时只更新轮转时间），供共享轮转时钟的包装sink使用（调用方持有锁） */
+    void rotate_by_date_(log_clock::time_point time);
+    void end_frame_(); /* 结束流式编码的当前帧 */
+    void write_binary_(const details::log_msg &msg); /* 二进制模式下编码并写入一条记录 */
+    /* 重复抑制后写入一条记录（调用方持有锁）；formatted非空时是包装sink按共享格式已格式化的文本 */
+    void log_record_(const details::log_msg &msg, const memory_buf_t *formatted);
+    /* 格式化（或二进制编码）并写入；本sink单独设置过格式或为二进制模式时不使用preformatted */
+    void write_record_(const details::log_msg &msg, const memory_buf_t *preformatted);
+    /* 写出重复抑制的汇总，current为触发汇总的记录（提供时间和同一键的logger名） */
+    void write_summary_(const details::suppression_summary &summary,
+                        const details::log_msg &current);
+    void write_idle_summaries_(log_clock::time_point time, bool force);
+    void sync_shared_();   /* 多进程模式：按共享状态更新大小和轮转时间，代数变化时重新打开 */
+    void reopen_shared_(); /* 多进程模式：重新打开当前文件 */
+    void rotate_shared_(); /* 多进程模式的轮转，持有进程间锁 */
+    void index_record_(log_clock::time_point time); /* 按需为即将写入的记录建索引条目 */
+    /* 取走当前文件的索引条目交给维护任务写出，没有条目时返回nullptr */
+    std::shared_ptr<std::vector<details::time_index_entry>> take_index_();
+
+    filename_t calc_backup_filename(log_clock::time_point tp, std::uint64_t sequence);
+    /* 扫描目录中的全部备份文件；known（备份清单的内容）中仍存在的文件沿用已有记录，
+       不再解析和stat，reused为沿用的条数 */
+    std::vector<details::backup_file> scan_backup_files_(std::vector<details::backup_file> known,
+                                                         std::size_t &reused);
+    bool init_backup_catalog_(); /* 读入了备份清单（未与目录核对）时返回true */
+    void reconcile_backup_catalog_();
+    void add_backup_(details::backup_file file);
+    void process_backup_(const std::shared_ptr<details::backup_processor> &processor,
+                         const filename_t &backup_filename);
+    void replace_backup_(const filename_t &backup_filename,
+                         const filename_t &result_filename,
+                         std::size_t result_size);
     void clean_old_files();
+    /* 清理条件的快照，维护任务使用提交时的值 */
+    struct retention_policy {
+        std::size_t max_files;
+        std::chrono::hours max_age;
+        std::size_t max_total_size;
+    };
+    retention_policy retention_() const;
+    void remove_expired_backups_(const retention_policy &policy);
+    void run_maintenance_(std::function<void()> task);
     void rotate_();
+    void rotate_to_standby_(std::unique_ptr<details::file_helper> standby);
+    void prepare_standby_(const filename_t &standby_filename);
+    /* 待命文件改名为当前文件失败后，关闭待命文件（其中的记录保留为一个备份）并重新打开当前文件 */
+    void recover_standby_();
+    /* 把非空的待命文件改名为备份并登记，失败时返回false */
+    bool salvage_standby_(const filename_t &standby_filename, std::size_t size);
+    std::unique_ptr<details::file_helper> take_standby_();
+    void drop_standby_();
 
     /* 辅助函数 */
     bool create_directories(const filename_t &path);
@@ -60,19 +253,75 @@ private:
     bool file_exists(const filename_t &path);
     bool rename_file(const filename_t &src, const filename_t &dst);
     time_t get_file_modification_time(const filename_t &path);
-    std::time_t extract_time_from_filename(const std::string &filename);
+    std::size_t get_file_size(const filename_t &path);
 
     filename_t base_filename_;      /* 完整路径和原始文件名 */
     filename_t base_filename_only_; /* 仅包含文件名部分 */
     filename_t directory_;          /* 仅包含目录部分 */
-    log_clock::time_point rotation_tp_;
-    details::file_helper file_helper_;
+    /* 备份文件名的生成和解析，以及最近一个备份的轮转序号 */
+    details::backup_name naming_;
+    std::uint64_t backup_sequence_ = 0;
+    details::rotation_schedule schedule_;
+    log_clock::time_point rotation_tp_; /* 下一个日期轮转边界，记录时间不早于它时轮转 */
+    std::unique_ptr<details::file_helper> file_helper_;
+    file_event_handlers event_handlers_;
     std::chrono::hours max_age_;
     std::size_t max_size_;
     std::size_t max_files_;
+    std::size_t max_total_size_ = 0;
     bool truncate_;
-    details::circular_q<filename_t> filenames_q_;
+    details::backup_catalog backups_; /* 按时间排序的备份文件目录，启用维护线程后只在该线程访问 */
+    /* 备份清单（"<base>.manifest"），启动时代替目录扫描；缺失或损坏时退回扫描并重建 */
+    std::unique_ptr<details::backup_manifest> manifest_;
+    /* 启动时读入的清单尚未与目录核对；核对只涉及构造之前产生的备份（时间早于catalog_loaded_at_），
+       在构造之后的第一个清理任务中（或切换到维护线程时）进行，与其他维护任务串行 */
+    bool catalog_unverified_ = false;
+    std::time_t catalog_loaded_at_ = 0;
+    std::shared_ptr<details::maintenance_worker> maintenance_;
+    std::shared_ptr<details::backup_processor> processor_;
+    bool standby_enabled_ = false;
+    std::mutex standby_mutex_; /* 保护standby_，由日志线程取走、维护任务补充 */
+    std::unique_ptr<details::file_helper> standby_;
+    std::atomic<bool> standby_failed_{false}; /* 维护任务改名失败，日志线程仍写在待命文件上 */
     std::size_t current_size_;
+    std::size_t combine_limit_ = 0; /* 合并写缓冲区大小，0表示不合并 */
+    memory_buf_t combine_buf_;
+    std::unique_ptr<details::append_file> direct_; /* 合并写的写入句柄，未启用时为空 */
+    std::unique_ptr<details::stream_encoder> encoder_;
+    memory_buf_t encoded_buf_;
+    filename_t backup_suffix_; /* 备份文件名的附加后缀（流式编码时为编码器后缀） */
+    std::unique_ptr<details::binary_record_encoder> binary_;
+    memory_buf_t binary_buf_;
+    bool own_formatter_ = false; /* 单独设置过格式（set_pattern/set_formatter/set_dately_file_pattern） */
+    /* 由preformat/combining包装sink持有：记录是包装sink格式化好的文本，经write_formatted_直接写入，
+       不经过sink_it_，只能是文本格式 */
+    bool preformatted_only_ = false;
+    details::flush_policy flush_policy_ = {0, std::chrono::milliseconds(0), false};
+    std::size_t unflushed_bytes_ = 0;
+    log_clock::time_point last_flush_time_;
+    std::shared_ptr<details::sync_file> sync_file_; /* 当前文件的落盘句柄，仅durable时打开 */
+    details::group_commit commit_;
+    bool preallocate_ = false;
+    std::size_t evict_window_ = 0;
+    std::shared_ptr<details::file_tuner> tuner_; /* 当前文件的空间/页缓存管理，未启用时为空 */
+    /* 异步写入，启用时file_helper_只用于打开/关闭文件，不再写入 */
+    std::shared_ptr<details::async_file_writer> writer_;
+    std::unique_ptr<details::flight_recorder> recorder_; /* 未启用时为空 */
+    memory_buf_t recorder_buf_;                          /* 二进制模式下格式化的文本 */
+    std::unique_ptr<details::log_suppressor> suppressor_; /* 未启用时为空 */
+    std::vector<details::suppression_summary> idle_summaries_;
+    memory_buf_t summary_buf_;
+    std::unique_ptr<details::shared_rotation> shared_; /* 多进程模式，未启用时为空 */
+    std::uint64_t shared_generation_ = 0;             /* 当前打开的文件对应的轮转代数 */
+    std::uint64_t shared_seen_sequence_ = 0; /* 已登记到备份目录的最大序号 */
+#ifdef SPDLOG_DATELY_METRICS
+    details::sink_metrics metrics_;
+#endif
+    std::size_t index_every_bytes_ = 0; /* 时间索引的字节间隔，0表示不建索引 */
+    std::chrono::milliseconds index_interval_{0};
+    std::vector<details::time_index_entry> index_; /* 当前文件的索引条目 */
+    std::size_t index_last_offset_ = 0;
+    log_clock::time_point index_last_time_;
 };
 
 using rotating_dately_file_sink_mt = rotating_dately_file_sink<std::mutex>;
@@ -0,0 +1,167 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/sinks/routing_dately_file_sink.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+
+namespace spdlog {
+namespace sinks {
+
+namespace routing_detail {
+
+/* 备份文件名前缀：文件名去掉扩展名后加'_'，如 "logs/warn.log" -> "warn_" */
+inline filename_t backup_prefix(const filename_t &base_filename) {
+    std::size_t slash = base_filename.find_last_of(SPDLOG_FILENAME_T("/\\"));
+    filename_t name = slash == filename_t::npos ? base_filename : base_filename.substr(slash + 1);
+    std::size_t dot = name.rfind('.');
+    if (dot != filename_t::npos && dot != 0) {
+        name.erase(dot);
+    }
+    return name + SPDLOG_FILENAME_T("_");
+}
+
+/* 目录加备份前缀，相同时两个输出的备份无法区分，如 "logs/warn.log" -> "logs/warn_" */
+inline filename_t backup_key(const filename_t &base_filename) {
+    std::size_t slash = base_filename.find_last_of(SPDLOG_FILENAME_T("/\\"));
+    filename_t directory =
+        slash == filename_t::npos ? filename_t() : base_filename.substr(0, slash);
+    return directory + SPDLOG_FILENAME_T("/") + backup_prefix(base_filename);
+}
+
+}  // namespace routing_detail
+
+SPDLOG_INLINE routing_dately_file_sink::routing_dately_file_sink(
+    std::chrono::hours max_age,
+    std::size_t max_files,
+    bool truncate,
+    const file_event_handlers &event_handlers)
+    : max_age_(max_age),
+      max_files_(max_files),
+      truncate_(truncate),
+      event_handlers_(event_handlers),
+      maintenance_(std::make_shared<details::maintenance_worker>()),
+      rotation_tp_(log_clock::time_point::max().time_since_epoch().count()) {}
+
+SPDLOG_INLINE std::shared_ptr<rotating_dately_file_sink_mt> routing_dately_file_sink::add_route(
+    const filename_t &base_filename,
+    level::level_enum min_level,
+    const std::string &logger_name,
+    std::size_t max_size) {
+    filename_t backup_key = routing_detail::backup_key(base_filename);
+    for (const auto &r : routes_) {
+        if (r.backup_key == backup_key) {
+            throw_spdlog_ex("routing_dately_file_sink: " +
+                            details::os::filename_to_str(base_filename) +
+                            " has the same backup prefix as " +
+                            details::os::filename_to_str(r.output->filename()) +
+                            " in the same directory");
+        }
+    }
+
+    auto output = std::make_shared<rotating_dately_file_sink_mt>(
+        base_filename, max_age_, max_size, max_files_, truncate_, event_handlers_, false,
+        routing_detail::backup_prefix(base_filename));
+    output->set_maintenance_worker(maintenance_);
+    output->set_rotation_schedule(schedule_);
+    route r;
+    r.min_level = min_level;
+    r.logger_name = logger_name;
+    r.output = output;
+    r.backup_key = std::move(backup_key);
+    routes_.push_back(std::move(r));
+
+    /* 各输出构造时计算的轮转时间相同（跨越边界时取较早者） */
+    rotation_tp_ = std::min(rotation_tp_.load(), output->rotation_tp_.time_since_epoch().count());
+    return output;
+}
+
+/* 路由条件和输出自己的级别（set_level）都满足 */
+SPDLOG_INLINE bool routing_dately_file_sink::matches_(const route &r,
+                                                      const details::log_msg &msg) const {
+    return msg.level >= r.min_level &&
+           (r.logger_name.empty() || string_view_t(r.logger_name) == msg.logger_name) &&
+           r.output->should_log(msg.level);
+}
+
+SPDLOG_INLINE void routing_dately_file_sink::log(const details::log_msg &msg) {
+    /* 没有匹配的输出时不格式化 */
+    bool matched = false;
+    for (const auto &r : routes_) {
+        if (matches_(r, msg)) {
+            matched = true;
+            break;
+        }
+    }
+    if (!matched) {
+        return;
+    }
+
+    /* 在锁外格式化一次，各输出写入同一缓冲区 */
+    static thread_local memory_buf_t formatted;
+    formatted.clear();
+    formatter_.format(msg, formatted);
+
+    if (msg.time.time_since_epoch().count() >= rotation_tp_.load(std::memory_order_relaxed)) {
+        rotate_all_(msg.time);
+    }
+    for (const auto &r : routes_) {
+        if (matches_(r, msg)) {
+            std::lock_guard<std::mutex> lock(r.output->mutex_);
+            r.output->log_record_(msg, &formatted);
+        }
+    }
+}
+
+SPDLOG_INLINE void routing_dately_file_sink::rotate_all_(log_clock::time_point time) {
+    std::lock_guard<std::mutex> rotation_lock(rotation_mutex_);
+    if (time.time_since_epoch().count() < rotation_tp_.load()) {
+        return; /* 其他线程已完成轮转 */
+    }
+    log_clock::rep next = log_clock::time_point::max().time_since_epoch().count();
+    for (const auto &r : routes_) {
+        std::lock_guard<std::mutex> lock(r.output->mutex_);
+        r.output->rotate_by_date_(time);
+        next = std::min(next, r.output->rotation_tp_.time_since_epoch().count());
+    }
+    rotation_tp_ = next;
+}
+
+SPDLOG_INLINE void routing_dately_file_sink::flush() {
+    for (const auto &r : routes_) {
+        r.output->flush();
+    }
+}
+
+SPDLOG_INLINE void routing_dately_file_sink::set_pattern(const std::string &pattern) {
+    formatter_.set_pattern(pattern);
+}
+
+SPDLOG_INLINE void routing_dately_file_sink::set_formatter(
+    std::unique_ptr<spdlog::formatter> sink_formatter) {
+    formatter_.set_formatter(std::move(sink_formatter));
+}
+
+SPDLOG_INLINE void routing_dately_file_sink::set_rotation_schedule(
+    const details::rotation_schedule &schedule) {
+    std::lock_guard<std::mutex> rotation_lock(rotation_mutex_);
+    schedule_ = schedule;
+    log_clock::rep next = log_clock::time_point::max().time_since_epoch().count();
+    for (const auto &r : routes_) {
+        r.output->set_rotation_schedule(schedule_);
+        std::lock_guard<std::mutex> lock(r.output->mutex_);
+        next = std::min(next, r.output->rotation_tp_.time_since_epoch().count());
+    }
+    rotation_tp_ = next;
+}
+
+SPDLOG_INLINE std::shared_ptr<details::maintenance_worker>
+routing_dately_file_sink::maintenance_worker() const {
+    return maintenance_;
+}
+
+}  // namespace sinks
+}  // namespace spdlog
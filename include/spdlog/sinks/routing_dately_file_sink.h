@@ -0,0 +1,79 @@
+#pragma once
+
+#include "spdlog/details/maintenance_worker.h"
+#include "spdlog/details/striped_formatter.h"
+#include "spdlog/sinks/rotating_dately_file_sink.h"
+#include "spdlog/sinks/sink.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * 按级别/logger名分流到多个rotating_dately_file_sink_mt（如 全部、warn以上、审计）：
+ * 每条记录在锁外只格式化一次，依次写入匹配的输出，各输出有自己的max_size和锁
+ * 所有输出共享一个轮转时钟（到达轮转边界时一起轮转，没有新记录的输出也不例外）和一个维护线程，
+ * 备份清理都在该线程上进行；备份文件名前缀取输出文件名去掉扩展名后加'_'（"warn.log" -> "warn_"），
+ * 同一目录下的多个输出互不认领对方的备份，前缀相同（如"a.log"和"a.txt"）时add_route()抛出异常
+ * 输出须在开始记录日志前添加；格式通过本对象的set_pattern/set_formatter设置，
+ * 其余配置通过add_route()返回的sink设置：输出的级别、重复抑制和二进制模式照常生效，
+ * 输出单独设置了格式时为该输出再格式化一次
+ */
+class routing_dately_file_sink final : public sink {
+public:
+    explicit routing_dately_file_sink(std::chrono::hours max_age = std::chrono::hours(24 * 30),
+                                      std::size_t max_files = 0,
+                                      bool truncate = false,
+                                      const file_event_handlers &event_handlers = {});
+
+    /* 添加输出：级别不低于min_level，且logger_name为空或与记录的logger名相同的记录写入该输出 */
+    std::shared_ptr<rotating_dately_file_sink_mt> add_route(
+        const filename_t &base_filename,
+        level::level_enum min_level,
+        const std::string &logger_name = std::string(),
+        std::size_t max_size = 1024 * 1024 * 10);
+
+    void log(const details::log_msg &msg) override;
+    void flush() override;
+    void set_pattern(const std::string &pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    /* 所有输出（包括之后添加的）的日期轮转周期，见rotating_dately_file_sink::set_rotation_schedule */
+    void set_rotation_schedule(const details::rotation_schedule &schedule);
+
+    /* 所有输出共享的维护线程 */
+    std::shared_ptr<details::maintenance_worker> maintenance_worker() const;
+
+private:
+    struct route {
+        level::level_enum min_level;
+        std::string logger_name;
+        std::shared_ptr<rotating_dately_file_sink_mt> output;
+        filename_t backup_key; /* 目录加备份前缀，见routing_detail::backup_key */
+    };
+
+    bool matches_(const route &r, const details::log_msg &msg) const;
+    void rotate_all_(log_clock::time_point time); /* 到达轮转边界时轮转全部输出 */
+
+    std::chrono::hours max_age_;
+    std::size_t max_files_;
+    bool truncate_;
+    file_event_handlers event_handlers_;
+    std::vector<route> routes_;
+    std::shared_ptr<details::maintenance_worker> maintenance_;
+    details::rotation_schedule schedule_;
+    std::mutex rotation_mutex_;
+    std::atomic<log_clock::rep> rotation_tp_; /* 共享的下一个日期轮转时间 */
+    details::striped_formatter formatter_;
+};
+
+}  // namespace sinks
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "routing_dately_file_sink-inl.h"
+#endif
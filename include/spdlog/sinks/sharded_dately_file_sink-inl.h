@@ -0,0 +1,298 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/sinks/sharded_dately_file_sink.h>
+#endif
+
+#include <spdlog/details/compiled_pattern.h>
+#include <spdlog/details/os.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/pattern_formatter.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+namespace spdlog {
+namespace sinks {
+
+SPDLOG_INLINE sharded_dately_file_sink::sharded_dately_file_sink(
+    const filename_t &base_filename,
+    std::size_t shards,
+    std::chrono::hours max_age,
+    std::size_t max_size,
+    std::size_t max_files,
+    bool truncate,
+    const file_event_handlers &event_handlers,
+    const filename_t &backup_prefix)
+    : base_filename_(base_filename),
+      naming_(backup_prefix),
+      max_age_(max_age),
+      max_size_(max_size),
+      max_files_(max_files),
+      truncate_(truncate) {
+    if (max_size == 0) {
+        throw_spdlog_ex("sharded_dately_file_sink constructor: max_size arg cannot be zero");
+    }
+    if (shards == 0) {
+        shards = std::max(1u, std::thread::hardware_concurrency());
+    }
+    max_shard_files_ = shards;
+
+    size_t pos = base_filename_.find_last_of("/\\");
+    if (pos != filename_t::npos) {
+        directory_ = base_filename_.substr(0, pos);
+        details::os::create_dir(directory_);
+    }
+
+    /* 打开各分片的当前文件 */
+    shards_.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i) {
+        std::unique_ptr<shard> s(new shard(event_handlers));
+        s->formatter.reset(new pattern_formatter());
+        s->file.open(shard_filename(i), truncate_);
+        s->size = s->file.size();
+        shards_.push_back(std::move(s));
+    }
+    rotation_tp_.store(schedule_.next_boundary(log_clock::now()).time_since_epoch().count());
+
+    init_backup_catalog_();
+    std::lock_guard<std::mutex> lock(rotation_mutex_);
+    remove_expired_backups_();
+}
+
+SPDLOG_INLINE void sharded_dately_file_sink::log(const details::log_msg &msg) {
+    std::size_t index = msg.thread_id % shards_.size();
+    shard &s = *shards_[index];
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    s.buf.clear();
+    s.formatter->format(msg, s.buf);
+
+    /* 到达日期轮转时间或本分片写满时开始新批次，所有分片随后各自轮转 */
+    std::uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (msg.time.time_since_epoch().count() >= rotation_tp_.load(std::memory_order_relaxed)) {
+        start_generation_(generation, true, msg.time);
+    } else if (s.size > 0 && s.size + s.buf.size() > max_size_) {
+        start_generation_(generation, false, msg.time);
+    }
+    if (s.generation != generation_.load(std::memory_order_acquire)) {
+        rotate_shard_(s, index);
+    }
+
+    s.file.write(s.buf);
+    s.size += s.buf.size();
+}
+
+SPDLOG_INLINE void sharded_dately_file_sink::flush() {
+    for (auto &s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->file.flush();
+    }
+}
+
+SPDLOG_INLINE void sharded_dately_file_sink::set_pattern(const std::string &pattern) {
+    set_formatter(details::make_pattern_formatter(pattern));
+}
+
+SPDLOG_INLINE void sharded_dately_file_sink::set_formatter(
+    std::unique_ptr<spdlog::formatter> sink_formatter) {
+    for (auto &s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->formatter = sink_formatter->clone();
+    }
+}
+
+SPDLOG_INLINE void sharded_dately_file_sink::set_rotation_schedule(
+    const details::rotation_schedule &schedule) {
+    std::lock_guard<std::mutex> lock(rotation_mutex_);
+    schedule_ = schedule;
+    rotation_tp_.store(schedule_.next_boundary(log_clock::now()).time_since_epoch().count(),
+                       std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE std::size_t sharded_dately_file_sink::shard_count() const { return shards_.size(); }
+
+SPDLOG_INLINE filename_t sharded_dately_file_sink::shard_filename(std::size_t index) const {
+    return fmt_lib::format(SPDLOG_FILENAME_T("{}.{}"), base_filename_, index);
+}
+
+/* 开始新批次；seen是调用方看到的批次号，其他分片已经开始了新批次时不再重复 */
+SPDLOG_INLINE void sharded_dately_file_sink::start_generation_(std::uint64_t seen,
+                                                               bool by_date,
+                                                               log_clock::time_point time) {
+    std::lock_guard<std::mutex> lock(rotation_mutex_);
+    if (by_date) {
+        if (time.time_since_epoch().count() < rotation_tp_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        rotation_tp_.store(schedule_.next_boundary(time).time_since_epoch().count(),
+                           std::memory_order_relaxed);
+    } else if (generation_.load(std::memory_order_relaxed) != seen) {
+        return;
+    }
+
+    auto now = log_clock::now();
+    generation_prefix_ = calc_backup_prefix_(now, ++backup_sequence_);
+    generation_time_ = log_clock::to_time_t(now);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+/* 把分片的当前文件改名为所属批次的备份（调用方持有分片锁） */
+SPDLOG_INLINE void sharded_dately_file_sink::rotate_shard_(shard &s, std::size_t index) {
+    using details::os::filename_to_str;
+
+    filename_t prefix;
+    std::time_t time;
+    std::uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(rotation_mutex_);
+        prefix = generation_prefix_;
+        time = generation_time_;
+        sequence = backup_sequence_;
+        s.generation = generation_.load(std::memory_order_relaxed);
+    }
+    if (s.size == 0) {
+        return;
+    }
+
+    filename_t filename = shard_filename(index);
+    filename_t backup_filename = fmt_lib::format(SPDLOG_FILENAME_T("{}.{}"), prefix, index);
+    s.file.close();
+    if (std::rename(filename.c_str(), backup_filename.c_str()) != 0) {
+        /* 改名失败时恢复原状：追加打开原文件，大小不变，不登记备份，到下一批次再轮转 */
+        int rename_errno = errno;
+        s.file.open(filename, false);
+        throw_spdlog_ex("sharded_dately_file_sink: failed renaming " + filename_to_str(filename) +
+                            " to " + filename_to_str(backup_filename),
+                        rename_errno);
+    }
+
+    /* 备份已经存在，先登记（同一批次的各分片累加大小），再打开新的当前文件 */
+    std::size_t backup_size = s.size;
+    s.size = 0;
+    {
+        std::lock_guard<std::mutex> lock(rotation_mutex_);
+        const details::backup_file *existing = backups_.find(prefix);
+        if (existing != nullptr) {
+            backups_.replace(prefix, prefix, existing->size + backup_size);
+        } else {
+            backups_.add({prefix, time, backup_size, sequence});
+            remove_expired_backups_();
+        }
+    }
+    s.file.open(filename, truncate_);
+    s.size = s.file.size();
+}
+
+/* 批次前缀："<目录>/<备份名>.log"，分片文件在其后追加".<分片号>" */
+SPDLOG_INLINE filename_t sharded_dately_file_sink::calc_backup_prefix_(
+    log_clock::time_point tp, std::uint64_t sequence) const {
+    filename_t full_dir = directory_;
+    if (!full_dir.empty()) {
+        full_dir += '/';
+    }
+    return full_dir + naming_.format(tp, sequence);
+}
+
+/* 扫描一次目录，按批次汇总已有的分片备份 */
+SPDLOG_INLINE void sharded_dately_file_sink::init_backup_catalog_() {
+    std::map<filename_t, details::backup_file> batches;
+    filename_t full_dir = directory_.empty() ? filename_t() : directory_ + "/";
+    /* 只接受 "<备份名>.log.<分片号>"，批次前缀为分片号之前的部分 */
+    auto add_file = [&](const filename_t &name, std::size_t size) {
+        details::backup_stamp stamp;
+        std::size_t suffix_pos;
+        if (!naming_.parse(name, stamp, suffix_pos) || suffix_pos + 1 >= name.size() ||
+            name[suffix_pos] != '.') {
+            return;
+        }
+        std::size_t index = 0;
+        for (std::size_t i = suffix_pos + 1; i < name.size(); ++i) {
+            if (name[i] < '0' || name[i] > '9') {
+                return;
+            }
+            index = index * 10 + static_cast<std::size_t>(name[i] - '0');
+        }
+        max_shard_files_ = std::max(max_shard_files_, index + 1);
+        filename_t prefix = name.substr(0, suffix_pos);
+        details::backup_file &batch = batches[prefix];
+        batch.filename = full_dir + prefix;
+        batch.time = stamp.time;
+        batch.size += size;
+        batch.sequence = stamp.sequence;
+    };
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA find_data;
+    HANDLE hFind =
+        FindFirstFileA((full_dir + naming_.prefix() + "*.log.*").c_str(), &find_data);
+    if (hFind != INVALID_HANDLE_VALUE) {
+        do {
+            if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                add_file(find_data.cFileName,
+                         static_cast<std::size_t>(
+                             (static_cast<unsigned long long>(find_data.nFileSizeHigh) << 32) |
+                             find_data.nFileSizeLow));
+            }
+        } while (FindNextFileA(hFind, &find_data) != 0);
+        FindClose(hFind);
+    }
+#else
+    DIR *dir = opendir(directory_.empty() ? "." : directory_.c_str());
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            struct stat st;
+            if (strncmp(entry->d_name, naming_.prefix().c_str(), naming_.prefix().size()) == 0 &&
+                stat((full_dir + entry->d_name).c_str(), &st) == 0) {
+                add_file(entry->d_name, static_cast<std::size_t>(st.st_size));
+            }
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::vector<details::backup_file> entries;
+    for (auto &batch : batches) {
+        entries.push_back(std::move(batch.second));
+    }
+    std::sort(entries.begin(), entries.end(), details::backup_older);
+    for (auto &entry : entries) {
+        backup_sequence_ = std::max(backup_sequence_, entry.sequence);
+        backups_.add(std::move(entry));
+    }
+}
+
+/* 按批次数和保留时间清理，删除整批的分片文件（调用方持有rotation_mutex_） */
+SPDLOG_INLINE void sharded_dately_file_sink::remove_expired_backups_() {
+    auto now = std::time(nullptr);
+    auto max_age_seconds = std::chrono::duration_cast<std::chrono::seconds>(max_age_).count();
+
+    while (!backups_.empty()) {
+        const details::backup_file &oldest = backups_.oldest();
+        bool over_count = max_files_ != 0 && backups_.size() > max_files_;
+        bool expired = now - oldest.time > max_age_seconds;
+        if (!over_count && !expired) {
+            break;
+        }
+        for (std::size_t i = 0; i < max_shard_files_; ++i) {
+            filename_t filename = fmt_lib::format(SPDLOG_FILENAME_T("{}.{}"), oldest.filename, i);
+            std::remove(filename.c_str());
+        }
+        backups_.pop_oldest();
+    }
+}
+
+}  // namespace sinks
+}  // namespace spdlog
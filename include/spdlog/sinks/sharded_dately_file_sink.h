@@ -0,0 +1,98 @@
+#pragma once
+
+#include "spdlog/details/backup_catalog.h"
+#include "spdlog/details/backup_name.h"
+#include "spdlog/details/file_helper.h"
+#include "spdlog/details/rotation_schedule.h"
+#include "spdlog/sinks/sink.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * 分片的按日期/大小轮转文件sink：每个分片有自己的锁和当前文件（"<base>.<分片号>"），
+ * 写线程按线程id映射到分片，不再共用一把sink锁
+ *
+ * 轮转按批次进行：任一分片超过max_size或到达日期轮转时间时开始新批次，
+ * 各分片在下一次写入时把当前文件改名为 "<批次备份名>.<分片号>"（同一批次同一个名字，
+ * 格式见details::backup_name，如 "app_YYYYmmdd_HHMMSS_uuuuuu_NNNNNNNN.log.3"），
+ * 空文件不改名；备份目录以批次为单位，max_files为保留的批次数，清理时删除整批的分片文件
+ * 按时间读取各分片用details::merged_log_reader::add_shards()
+ * 备份文件名与rotating_dately_file_sink不同，两者不要使用同一目录
+ */
+class sharded_dately_file_sink final : public sink {
+public:
+    explicit sharded_dately_file_sink(const filename_t &base_filename,
+                                      std::size_t shards = 0, /* 0表示硬件线程数 */
+                                      std::chrono::hours max_age = std::chrono::hours(24 * 30),
+                                      std::size_t max_size = 1024 * 1024 * 10, /* 每个分片 */
+                                      std::size_t max_files = 0,
+                                      bool truncate = false,
+                                      const file_event_handlers &event_handlers = {},
+                                      const filename_t &backup_prefix = SPDLOG_FILENAME_T("app_"));
+
+    void log(const details::log_msg &msg) override;
+    void flush() override;
+    void set_pattern(const std::string &pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    /* 按日期轮转的周期（默认每天本地时间0点），按记录时间判断，见details::rotation_schedule */
+    void set_rotation_schedule(const details::rotation_schedule &schedule);
+
+    std::size_t shard_count() const;
+    filename_t shard_filename(std::size_t index) const;
+
+private:
+    struct shard {
+        explicit shard(const file_event_handlers &event_handlers)
+            : file(event_handlers) {}
+
+        std::mutex mutex;
+        details::file_helper file;
+        std::unique_ptr<spdlog::formatter> formatter;
+        memory_buf_t buf;
+        std::size_t size = 0;
+        std::uint64_t generation = 0; /* 当前文件所属的轮转批次 */
+    };
+
+    void start_generation_(std::uint64_t seen, bool by_date, log_clock::time_point time);
+    void rotate_shard_(shard &s, std::size_t index);
+    filename_t calc_backup_prefix_(log_clock::time_point tp, std::uint64_t sequence) const;
+    void init_backup_catalog_();
+    void remove_expired_backups_();
+
+    filename_t base_filename_;
+    filename_t directory_;
+    details::backup_name naming_;
+    std::chrono::hours max_age_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+    bool truncate_;
+    std::vector<std::unique_ptr<shard>> shards_;
+    std::size_t max_shard_files_; /* 清理时每批检查的分片号范围（含以前运行时更多分片留下的文件） */
+
+    /* 共享的轮转时钟：批次号和下次按日期轮转的时间，日志线程无锁读取 */
+    std::atomic<std::uint64_t> generation_{0};
+    std::atomic<log_clock::rep> rotation_tp_;
+    details::rotation_schedule schedule_; /* rotation_mutex_保护 */
+
+    std::mutex rotation_mutex_; /* 保护批次的备份名和备份目录 */
+    filename_t generation_prefix_;
+    std::time_t generation_time_ = 0;
+    std::uint64_t backup_sequence_ = 0; /* 最近一个批次的轮转序号 */
+    details::backup_catalog backups_; /* 以批次为单位：文件名为不含分片号的前缀，大小为各分片之和 */
+};
+
+}  // namespace sinks
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "sharded_dately_file_sink-inl.h"
+#endif
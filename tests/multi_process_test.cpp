@@ -0,0 +1,258 @@
+/*
+ * rotating_dately_file_sink 多进程模式（set_multi_process）的测试
+ *
+ * 用法: multi_process_test [日志目录]（会被清空，默认multi_process_logs）
+ *
+ * 场景：
+ *   writers  8个fork出的写入进程共用一组文件，小max_size下频繁轮转：
+ *            每条记录完整且只出现一次，每个进程的记录跨备份保持顺序，每个备份序号只有一个文件
+ *   retain   同上并设置max_files：备份数不超过max_files
+ *   killed   持续写入时SIGKILL其中3个进程：其余进程正常结束（不死锁）
+ *   layout   控制文件来自不兼容的构建（大小不同）：构造时抛出异常，控制文件不被改写
+ *   rename   多进程模式下修改当前文件名：抛出异常，当前文件保持原名
+ */
+
+#include "spdlog/logger.h"
+#include "spdlog/sinks/rotating_dately_file_sink.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const int Processes = 8;
+
+int failures = 0;
+
+void check(bool condition, const std::string &scenario, const std::string &message) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL %s: %s\n", scenario.c_str(), message.c_str());
+        ++failures;
+    }
+}
+
+void clear_directory(const std::string &dir) {
+    mkdir(dir.c_str(), 0777);
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+            unlink((dir + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(d);
+}
+
+/* 备份（app_<时间>_<序号>.log）按序号排列，当前文件（app.log）在最后 */
+std::vector<std::pair<unsigned long, std::string>> list_log_files(const std::string &dir) {
+    std::vector<std::pair<unsigned long, std::string>> files;
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        return files;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        std::string name = entry->d_name;
+        if (name == "app.log") {
+            files.emplace_back(~0UL, name);
+        } else if (name.compare(0, 4, "app_") == 0 && name.size() > 12 &&
+                   name.compare(name.size() - 4, 4, ".log") == 0) {
+            std::string sequence = name.substr(name.size() - 12, 8);
+            files.emplace_back(std::strtoul(sequence.c_str(), nullptr, 10), name);
+        }
+    }
+    closedir(d);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/* 子进程：写入count条"p<进程> i<序号> <填充>"，返回退出码 */
+int run_writer(const std::string &dir, int process, int count, std::size_t max_files) {
+    try {
+        auto sink = std::make_shared<spdlog::sinks::rotating_dately_file_sink_mt>(
+            dir + "/app.log", std::chrono::hours(24 * 30), 4 * 1024, max_files);
+        sink->set_multi_process(true);
+        sink->set_dately_file_pattern("%v");
+        spdlog::logger logger("writer", sink);
+        for (int i = 0; i < count; ++i) {
+            logger.info("p{} i{} xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", process, i);
+        }
+        logger.flush();
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "writer %d: %s\n", process, ex.what());
+        return 1;
+    }
+    return 0;
+}
+
+/* fork出Processes个写入进程，返回各进程的pid */
+std::vector<pid_t> start_writers(const std::string &dir, int count, std::size_t max_files) {
+    std::vector<pid_t> pids;
+    for (int p = 0; p < Processes; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(run_writer(dir, p, count, max_files));
+        }
+        pids.push_back(pid);
+    }
+    return pids;
+}
+
+bool wait_writers(const std::vector<pid_t> &pids, const std::string &scenario) {
+    bool ok = true;
+    for (pid_t pid : pids) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL) {
+            continue;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            check(false, scenario, "writer " + std::to_string(pid) + " failed");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void test_writers(const std::string &dir) {
+    const int count = 20000;
+    clear_directory(dir);
+    if (!wait_writers(start_writers(dir, count, 0), "writers")) {
+        return;
+    }
+
+    std::vector<int> next(Processes, 0);
+    std::set<unsigned long> sequences;
+    std::size_t total = 0;
+    bool ordered = true, complete = true;
+    for (const auto &file : list_log_files(dir)) {
+        if (file.first != ~0UL) {
+            check(sequences.insert(file.first).second, "writers",
+                  "two backups with sequence " + std::to_string(file.first));
+        }
+        std::ifstream in(dir + "/" + file.second);
+        std::string line;
+        while (std::getline(in, line)) {
+            int p = -1, i = -1;
+            char fill[64] = {0};
+            if (std::sscanf(line.c_str(), "p%d i%d %63s", &p, &i, fill) != 3 || p < 0 ||
+                p >= Processes || std::strlen(fill) != 40) {
+                complete = false;
+                continue;
+            }
+            /* 每个进程的序号依次出现，缺失、重复和乱序都会使其与期望的下一个序号不同 */
+            ordered = ordered && i == next[p];
+            next[p] = i + 1;
+            ++total;
+        }
+    }
+    check(complete, "writers", "torn or malformed records");
+    check(ordered, "writers", "records lost, duplicated or out of order");
+    check(total == static_cast<std::size_t>(Processes) * count, "writers",
+          "expected " + std::to_string(Processes * count) + " records, read " +
+              std::to_string(total));
+    check(sequences.size() > 1, "writers", "no rotation happened");
+}
+
+void test_retain(const std::string &dir) {
+    const std::size_t max_files = 5;
+    clear_directory(dir);
+    if (!wait_writers(start_writers(dir, 5000, max_files), "retain")) {
+        return;
+    }
+    std::size_t backups = list_log_files(dir).size() - 1;
+    check(backups <= max_files, "retain",
+          std::to_string(backups) + " backups kept, max_files is 5");
+}
+
+void test_killed(const std::string &dir) {
+    clear_directory(dir);
+    std::vector<pid_t> pids = start_writers(dir, 50000, 0);
+    for (int k = 0; k < 3; ++k) {
+        usleep(20000);
+        kill(pids[static_cast<std::size_t>(k)], SIGKILL);
+    }
+    /* 死锁时由alarm结束整个测试 */
+    alarm(120);
+    wait_writers(pids, "killed");
+    alarm(0);
+}
+
+void test_layout(const std::string &dir) {
+    clear_directory(dir);
+    const std::string control = dir + "/app.log.ctl";
+    const std::string foreign(100, 'z');
+    {
+        std::ofstream out(control, std::ios::binary);
+        out << foreign;
+    }
+    bool thrown = false;
+    try {
+        auto sink = std::make_shared<spdlog::sinks::rotating_dately_file_sink_mt>(
+            dir + "/app.log", std::chrono::hours(24), 4 * 1024, 0);
+        sink->set_multi_process(true);
+    } catch (const spdlog::spdlog_ex &) {
+        thrown = true;
+    }
+    check(thrown, "layout", "incompatible control file accepted");
+
+    std::ifstream in(control, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    check(content == foreign, "layout", "incompatible control file was rewritten");
+}
+
+void test_rename(const std::string &dir) {
+    clear_directory(dir);
+    auto sink = std::make_shared<spdlog::sinks::rotating_dately_file_sink_mt>(
+        dir + "/app.log", std::chrono::hours(24), 4 * 1024, 0);
+    sink->set_multi_process(true);
+    bool thrown = false;
+    try {
+        sink->set_current_filename("other.log");
+    } catch (const spdlog::spdlog_ex &) {
+        thrown = true;
+    }
+    check(thrown, "rename", "current filename changed in multi-process mode");
+
+    struct stat st;
+    bool kept = stat((dir + "/app.log").c_str(), &st) == 0 &&
+                stat((dir + "/other.log").c_str(), &st) != 0;
+    check(kept, "rename", "shared base file was renamed");
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string dir = argc > 1 ? argv[1] : "multi_process_logs";
+
+    test_writers(dir);
+    test_retain(dir);
+    test_killed(dir);
+    test_layout(dir);
+    test_rename(dir);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all multi-process checks passed\n");
+    return 0;
+}